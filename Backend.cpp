@@ -0,0 +1,45 @@
+#include <Backend.hpp>
+#include <ResponseParser.hpp>
+#include <json.hpp>
+using json = nlohmann::json;
+
+bool TranslationBackend::ExtractText(std::string_view body, std::string &text) const
+{
+    return ExtractCandidateText(body, text);
+}
+
+GeminiBackend::GeminiBackend(std::string model, std::string base_url)
+    : model(std::move(model)), base_url(std::move(base_url))
+{
+}
+
+std::string GeminiBackend::Name() const
+{
+    return model;
+}
+
+std::string GeminiBackend::BuildUrl(const std::string &api_key, bool stream) const
+{
+    return base_url + model + (stream ? ":streamGenerateContent?alt=sse&key=" : ":generateContent?key=") + api_key;
+}
+
+std::string GeminiBackend::BuildBody(const std::string &prompt, std::string_view response_schema) const
+{
+    json payload = {
+        {"contents", {{{"parts", {{{"text", prompt}}}}}}}};
+    std::string body = payload.dump();
+    if (response_schema.empty())
+        return body;
+    // The schema is already serialized; splice it in rather than parsing
+    // it back into a json value for every request.
+    body.pop_back();
+    body += R"(,"generationConfig":{"responseMimeType":"application/json","responseSchema":)";
+    body += response_schema;
+    body += "}}";
+    return body;
+}
+
+MockBackend::MockBackend(int port)
+    : GeminiBackend("mock", "http://127.0.0.1:" + std::to_string(port) + "/v1beta/models/")
+{
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// Lookups are tagged with a class so interactive and bulk work can use
+// different models (and, later, different scheduling).
+enum class RequestClass
+{
+    Interactive,
+    Bulk
+};
+
+// Describes how to talk to one model endpoint. Translator owns the
+// transport (pooled handles, proxy, cancellation); a backend only builds
+// the request and reads the reply.
+class TranslationBackend
+{
+public:
+    virtual ~TranslationBackend() = default;
+
+    // Identifies the model behind the backend; part of every cache key.
+    virtual std::string Name() const = 0;
+    virtual std::string BuildUrl(const std::string &api_key, bool stream) const = 0;
+    // A non-empty response_schema asks for a JSON reply following it.
+    virtual std::string BuildBody(const std::string &prompt, std::string_view response_schema) const = 0;
+    // Defaults to the Gemini generateContent envelope.
+    virtual bool ExtractText(std::string_view body, std::string &text) const;
+};
+
+class GeminiBackend : public TranslationBackend
+{
+public:
+    explicit GeminiBackend(std::string model, std::string base_url = "https://generativelanguage.googleapis.com/v1beta/models/");
+
+    std::string Name() const override;
+    std::string BuildUrl(const std::string &api_key, bool stream) const override;
+    std::string BuildBody(const std::string &prompt, std::string_view response_schema) const override;
+
+private:
+    std::string model;
+    std::string base_url;
+};
+
+// Gemini-compatible backend pointed at a MockServer on the loopback
+// interface, for load tests and benchmarks without network access.
+class MockBackend : public GeminiBackend
+{
+public:
+    explicit MockBackend(int port);
+};
@@ -0,0 +1,101 @@
+#include <ClipboardWatcher.hpp>
+#include <wx/clipbrd.h>
+#include <wx/log.h>
+
+#include <TextNormalize.hpp>
+
+namespace
+{
+    const int kPollIntervalMs = 1000;
+    const std::chrono::milliseconds kDebounce(1500);
+}
+
+ClipboardWatcher::ClipboardWatcher(Translator &translator)
+    : m_translator(translator), m_timer(this)
+{
+    Bind(wxEVT_TIMER, &ClipboardWatcher::OnTimer, this, m_timer.GetId());
+}
+
+ClipboardWatcher::~ClipboardWatcher()
+{
+    Stop();
+}
+
+void ClipboardWatcher::Start()
+{
+    if (!m_timer.IsRunning())
+    {
+        m_timer.Start(kPollIntervalMs);
+        wxLogVerbose("Clipboard watcher started.");
+    }
+}
+
+void ClipboardWatcher::Stop()
+{
+    m_timer.Stop();
+    if (m_pending)
+        m_pending->Cancel();
+    m_pending.reset();
+}
+
+bool ClipboardWatcher::ReadClipboardText(std::string &text)
+{
+    wxClipboardLocker lock;
+    if (!lock || !wxTheClipboard->IsSupported(wxDF_TEXT))
+        return false;
+    wxTextDataObject data;
+    if (!wxTheClipboard->GetData(data))
+        return false;
+    const wxScopedCharBuffer utf8 = data.GetText().ToUTF8();
+    text = SanitizeInput(std::string(utf8.data(), utf8.length()));
+    return true;
+}
+
+bool ClipboardWatcher::AllowLookup(Clock::time_point now)
+{
+    while (!m_recentLookups.empty() && now - m_recentLookups.front() >= std::chrono::minutes(1))
+        m_recentLookups.pop_front();
+    if (m_recentLookups.size() >= m_maxPerMinute)
+        return false;
+    m_recentLookups.push_back(now);
+    return true;
+}
+
+void ClipboardWatcher::OnTimer(wxTimerEvent &event)
+{
+    (void)event; // Avoid unreferenced parameter warning
+
+    std::string text;
+    if (!ReadClipboardText(text))
+        return;
+
+    const Clock::time_point now = Clock::now();
+    if (text != m_candidate)
+    {
+        m_candidate = text;
+        m_candidateSince = now;
+        return;
+    }
+    if (now - m_candidateSince < kDebounce || text == m_lastTranslated)
+        return;
+
+    const size_t characters = CountCharacters(text);
+    if (characters == 0 || characters > m_maxLength || m_translator.getApiKey().empty())
+        return;
+    std::string persian;
+    if (m_dictionary && m_dictionary->IsOpen() && m_dictionary->Lookup(NormalizeKey(text), persian))
+        return;
+    // Only a lookup that actually starts marks the text as done; one held
+    // back by the cap is tried again on a later tick.
+    if (!AllowLookup(now))
+    {
+        wxLogVerbose("Clipboard watcher: rate limit reached, skipping pre-translation.");
+        return;
+    }
+
+    // Interactive class, so the result lands under the key the popup uses.
+    // The callback is empty: the point is to fill the cache.
+    m_pending = m_translator.TranslateAsync(text, TranslateCallback(), RequestClass::Interactive);
+    m_lastTranslated = text;
+    wxLogVerbose("Clipboard watcher: pre-translating %zu characters.", characters);
+}
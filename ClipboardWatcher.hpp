@@ -0,0 +1,51 @@
+#pragma once
+#include <wx/wx.h>
+#include <wx/timer.h>
+
+#include <chrono>
+#include <deque>
+#include <string>
+
+#include <OfflineDictionary.hpp>
+#include <Rest.hpp>
+
+// Polls the clipboard on a timer and pre-translates new text selections
+// into the translator's caches, so the hotkey popup can answer instantly.
+// A selection must stay unchanged for the debounce period, must fit the
+// length limit, and is subject to a per-minute cap on lookups. Words the
+// offline dictionary answers are skipped.
+class ClipboardWatcher : public wxEvtHandler
+{
+public:
+    explicit ClipboardWatcher(Translator &translator);
+    ~ClipboardWatcher();
+
+    void Start();
+    void Stop();
+    bool IsRunning() const { return m_timer.IsRunning(); }
+
+    // In characters (code points), not bytes.
+    void setMaxLength(size_t maxLength) { m_maxLength = maxLength; }
+    void setMaxPerMinute(size_t maxPerMinute) { m_maxPerMinute = maxPerMinute; }
+    // May be null; the dictionary must outlive the watcher.
+    void setOfflineDictionary(const OfflineDictionary *dictionary) { m_dictionary = dictionary; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void OnTimer(wxTimerEvent &event);
+    bool ReadClipboardText(std::string &text);
+    bool AllowLookup(Clock::time_point now);
+
+    Translator &m_translator;
+    const OfflineDictionary *m_dictionary = nullptr;
+    wxTimer m_timer;
+    size_t m_maxLength = 200;
+    size_t m_maxPerMinute = 6;
+
+    std::string m_candidate;
+    Clock::time_point m_candidateSince;
+    std::string m_lastTranslated;
+    std::deque<Clock::time_point> m_recentLookups;
+    std::shared_ptr<TranslationRequest> m_pending; // Latest lookup, cancelled by Stop().
+};
@@ -0,0 +1,284 @@
+#include <DiskCache.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    const char kFileMagic[4] = {'T', 'R', 'C', '1'};
+    const uint64_t kRecordHeaderSize = 12;
+
+    uint32_t Checksum(const std::string &key, const std::string &value)
+    {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : key)
+            hash = (hash ^ c) * 16777619u;
+        for (unsigned char c : value)
+            hash = (hash ^ c) * 16777619u;
+        return hash;
+    }
+
+    void PutU32(char *out, uint32_t v)
+    {
+        out[0] = static_cast<char>(v & 0xff);
+        out[1] = static_cast<char>((v >> 8) & 0xff);
+        out[2] = static_cast<char>((v >> 16) & 0xff);
+        out[3] = static_cast<char>((v >> 24) & 0xff);
+    }
+
+    uint32_t GetU32(const char *in)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(in);
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    void WriteRecord(std::ostream &out, const std::string &key, const std::string &value)
+    {
+        char header[kRecordHeaderSize];
+        PutU32(header, static_cast<uint32_t>(key.size()));
+        PutU32(header + 4, static_cast<uint32_t>(value.size()));
+        PutU32(header + 8, Checksum(key, value));
+        out.write(header, sizeof(header));
+        out.write(key.data(), key.size());
+        out.write(value.data(), value.size());
+    }
+}
+
+DiskCache::DiskCache(std::string path, uint64_t max_bytes)
+    : path(std::move(path)), max_bytes(max_bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Load();
+}
+
+void DiskCache::Load()
+{
+    index.clear();
+    lru.clear();
+    file_bytes = 0;
+    retry_compact_bytes = 0;
+
+    bool needs_rewrite = false;
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (in.is_open())
+        {
+            const uint64_t size = static_cast<uint64_t>(in.tellg());
+            in.seekg(0);
+            char magic[sizeof(kFileMagic)];
+            if (size > 0 && (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kFileMagic)))
+            {
+                needs_rewrite = true;
+            }
+            else if (size > 0)
+            {
+                uint64_t offset = sizeof(kFileMagic);
+                char header[kRecordHeaderSize];
+                std::string key;
+                while (offset < size)
+                {
+                    if (size - offset < kRecordHeaderSize || !in.read(header, sizeof(header)))
+                    {
+                        needs_rewrite = true;
+                        break;
+                    }
+                    const uint32_t key_len = GetU32(header);
+                    const uint32_t value_len = GetU32(header + 4);
+                    const uint64_t record_size = kRecordHeaderSize + key_len + value_len;
+                    if (size - offset < record_size)
+                    {
+                        needs_rewrite = true;
+                        break;
+                    }
+                    key.resize(key_len);
+                    in.read(&key[0], key_len);
+                    in.seekg(value_len, std::ios::cur);
+
+                    auto it = index.find(key);
+                    if (it != index.end())
+                    {
+                        lru.erase(it->second.lru);
+                        index.erase(it);
+                    }
+                    lru.push_front(key);
+                    index.emplace(key, Entry{offset + kRecordHeaderSize + key_len, value_len, GetU32(header + 8), lru.begin()});
+                    offset += record_size;
+                }
+                file_bytes = offset;
+            }
+        }
+    }
+
+    if (file_bytes == 0)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(kFileMagic, sizeof(kFileMagic));
+        file_bytes = sizeof(kFileMagic);
+        needs_rewrite = false;
+    }
+
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::app);
+    if (needs_rewrite || (file_bytes > max_bytes && !index.empty()))
+        Compact();
+}
+
+void DiskCache::Compact()
+{
+    // Keep the most recently used entries up to three quarters of the limit,
+    // so a full cache is not rewritten again on the very next store.
+    const uint64_t budget = max_bytes / 4 * 3;
+    std::vector<std::pair<std::string, std::string>> kept;
+    uint64_t kept_bytes = sizeof(kFileMagic);
+    for (const std::string &key : lru)
+    {
+        Entry &entry = index.at(key);
+        const uint64_t record_size = kRecordHeaderSize + key.size() + entry.length;
+        if (kept_bytes + record_size > budget)
+            break;
+        std::string value;
+        if (!ReadValue(entry, value))
+            continue;
+        kept.emplace_back(key, std::move(value));
+        kept_bytes += record_size;
+    }
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return;
+        out.write(kFileMagic, sizeof(kFileMagic));
+        for (auto it = kept.rbegin(); it != kept.rend(); ++it)
+            WriteRecord(out, it->first, it->second);
+        if (!out)
+            return;
+    }
+
+    file.close();
+    // rename() does not replace an existing file on Windows, so the old one
+    // has to go first there. If it cannot (another process has it open),
+    // keep appending to it as it is: reloading it would only compact again.
+    const bool replaced = std::rename(tmp_path.c_str(), path.c_str()) == 0;
+    if (!replaced && std::remove(path.c_str()) != 0)
+    {
+        std::remove(tmp_path.c_str());
+        retry_compact_bytes = file_bytes + max_bytes / 4;
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::app);
+        return;
+    }
+    // With the old file gone, a failed rename leaves Load() an empty cache.
+    if (!replaced && std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        std::remove(tmp_path.c_str());
+    Load();
+}
+
+bool DiskCache::ReadValue(const Entry &entry, std::string &value)
+{
+    if (!file.is_open())
+        return false;
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(entry.offset));
+    value.resize(entry.length);
+    if (!file.read(&value[0], entry.length))
+    {
+        file.clear();
+        return false;
+    }
+    const std::string &key = *entry.lru;
+    return Checksum(key, value) == entry.checksum;
+}
+
+void DiskCache::Touch(Entry &entry)
+{
+    lru.splice(lru.begin(), lru, entry.lru);
+}
+
+bool DiskCache::Lookup(const std::string &key, std::string &value)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end() || !ReadValue(it->second, value))
+    {
+        ++misses;
+        return false;
+    }
+    Touch(it->second);
+    ++hits;
+    return true;
+}
+
+void DiskCache::ForEach(const std::function<void(const std::string &key, const std::string &value)> &visit) const
+{
+    struct Item
+    {
+        std::string key;
+        uint64_t offset;
+        uint32_t length;
+        uint32_t checksum;
+    };
+    std::vector<Item> items;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.reserve(index.size());
+        for (const std::string &key : lru)
+        {
+            const Entry &entry = index.at(key);
+            items.push_back(Item{key, entry.offset, entry.length, entry.checksum});
+        }
+    }
+
+    // A compaction running meanwhile moves records; those fail the checksum
+    // and are skipped.
+    std::ifstream in(path, std::ios::binary);
+    std::string value;
+    for (const Item &item : items)
+    {
+        value.resize(item.length);
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(item.offset));
+        if (in.read(&value[0], item.length) && Checksum(item.key, value) == item.checksum)
+            visit(item.key, value);
+    }
+}
+
+void DiskCache::Store(const std::string &key, const std::string &value)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.is_open())
+        return;
+
+    file.clear();
+    file.seekp(0, std::ios::end);
+    WriteRecord(file, key, value);
+    file.flush();
+    if (!file)
+    {
+        file.clear();
+        return;
+    }
+
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        lru.erase(it->second.lru);
+        index.erase(it);
+    }
+    lru.push_front(key);
+    index.emplace(key, Entry{file_bytes + kRecordHeaderSize + key.size(), static_cast<uint32_t>(value.size()), Checksum(key, value), lru.begin()});
+    const uint64_t record_size = kRecordHeaderSize + key.size() + value.size();
+    file_bytes += record_size;
+
+    if (file_bytes > std::max(max_bytes, retry_compact_bytes))
+        Compact();
+}
+
+DiskCache::Stats DiskCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.entries = index.size();
+    stats.file_bytes = file_bytes;
+    return stats;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Append-only on-disk store of translation results. Startup only scans the
+// record headers and keys; values are read on demand. When the file grows
+// past the size limit it is rewritten with the most recently used entries.
+class DiskCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t entries = 0;
+        uint64_t file_bytes = 0;
+    };
+
+    DiskCache(std::string path, uint64_t max_bytes);
+
+    bool Lookup(const std::string &key, std::string &value);
+    void Store(const std::string &key, const std::string &value);
+    Stats GetStats() const;
+    // Visits every stored entry, most recently used first. Values are read
+    // through a separate stream, so lookups and stores are not held up.
+    void ForEach(const std::function<void(const std::string &key, const std::string &value)> &visit) const;
+
+private:
+    struct Entry
+    {
+        uint64_t offset;
+        uint32_t length;
+        uint32_t checksum;
+        std::list<std::string>::iterator lru;
+    };
+
+    void Load();
+    void Compact();
+    bool ReadValue(const Entry &entry, std::string &value);
+    void Touch(Entry &entry);
+
+    std::string path;
+    uint64_t max_bytes;
+    uint64_t file_bytes = 0;
+    // After a compaction that could not replace the file, the size at which
+    // to try again, so not every store rewrites the cache.
+    uint64_t retry_compact_bytes = 0;
+
+    mutable std::mutex mutex;
+    std::fstream file;
+    std::unordered_map<std::string, Entry> index;
+    std::list<std::string> lru; // Front is the most recently used key.
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
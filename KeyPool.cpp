@@ -0,0 +1,118 @@
+#include <KeyPool.hpp>
+#include <algorithm>
+
+KeyPool::Lease::~Lease()
+{
+    if (pool)
+        pool->Release(key);
+}
+
+void KeyPool::setKeys(std::vector<std::string> keys)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Entry> updated;
+    for (std::string &key : keys)
+    {
+        if (key.empty() || std::any_of(updated.begin(), updated.end(), [&](const Entry &e)
+                                       { return e.key == key; }))
+            continue;
+        // Keep load and cooldown for keys that stay configured.
+        auto existing = std::find_if(entries.begin(), entries.end(), [&](const Entry &e)
+                                     { return e.key == key; });
+        if (existing != entries.end())
+        {
+            updated.push_back(*existing);
+        }
+        else
+        {
+            Entry entry;
+            entry.key = std::move(key);
+            updated.push_back(std::move(entry));
+        }
+    }
+    entries = std::move(updated);
+    cursor = 0;
+}
+
+std::vector<std::string> KeyPool::Keys() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    for (const Entry &entry : entries)
+        keys.push_back(entry.key);
+    return keys;
+}
+
+KeyPool::Lease KeyPool::Acquire(const std::function<bool(const std::string &key)> &reserve)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entries.empty())
+        return Lease(nullptr, std::string());
+
+    const Clock::time_point now = Clock::now();
+    const size_t n = entries.size();
+    // Keys not cooling down, least loaded first and in rotation order from
+    // the cursor among equals.
+    std::vector<size_t> usable;
+    usable.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t index = (cursor + i) % n;
+        if (entries[index].cooling_until <= now)
+            usable.push_back(index);
+    }
+    std::stable_sort(usable.begin(), usable.end(), [this](size_t a, size_t b)
+                     { return entries[a].in_flight < entries[b].in_flight; });
+    size_t best = n;
+    if (reserve)
+    {
+        for (size_t index : usable)
+        {
+            if (reserve(entries[index].key))
+            {
+                best = index;
+                break;
+            }
+        }
+    }
+    if (best == n && !usable.empty())
+        best = usable.front();
+    if (best == n)
+    {
+        best = std::min_element(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+                                { return a.cooling_until < b.cooling_until; }) -
+               entries.begin();
+    }
+    cursor = (best + 1) % n;
+    ++entries[best].in_flight;
+    return Lease(this, entries[best].key);
+}
+
+void KeyPool::Cooldown(const std::string &key, std::chrono::milliseconds duration)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Entry &entry : entries)
+    {
+        if (entry.key == key)
+            entry.cooling_until = std::max(entry.cooling_until, Clock::now() + duration);
+    }
+}
+
+bool KeyPool::HasUsableKey() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point now = Clock::now();
+    return std::any_of(entries.begin(), entries.end(), [&](const Entry &e)
+                       { return e.cooling_until <= now; });
+}
+
+void KeyPool::Release(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Entry &entry : entries)
+    {
+        if (entry.key == key && entry.in_flight > 0)
+            --entry.in_flight;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The API keys a Translator may use. Each request leases the key with the
+// fewest requests in flight, rotating between equally loaded keys, and
+// skips keys that are cooling down after a quota or auth error. When every
+// key is cooling down the one that recovers first is used anyway, so
+// lookups degrade to waiting rather than failing outright.
+class KeyPool
+{
+public:
+    class Lease
+    {
+    public:
+        Lease(KeyPool *pool, std::string key) : pool(pool), key(std::move(key)) {}
+        Lease(Lease &&other) noexcept : pool(other.pool), key(std::move(other.key)) { other.pool = nullptr; }
+        ~Lease();
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        Lease &operator=(Lease &&) = delete;
+
+        const std::string &Key() const { return key; }
+
+    private:
+        KeyPool *pool;
+        std::string key;
+    };
+
+    void setKeys(std::vector<std::string> keys);
+    std::vector<std::string> Keys() const;
+    // The lease's key is empty if no keys are configured. With `reserve`
+    // set, usable keys are offered to it least loaded first and the first
+    // one it accepts is leased; if it accepts none, the least loaded is.
+    Lease Acquire(const std::function<bool(const std::string &key)> &reserve = nullptr);
+    void Cooldown(const std::string &key, std::chrono::milliseconds duration);
+    // True if some key is not cooling down.
+    bool HasUsableKey() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        std::string key;
+        size_t in_flight = 0;
+        Clock::time_point cooling_until;
+    };
+
+    void Release(const std::string &key);
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    size_t cursor = 0;
+};
@@ -0,0 +1,185 @@
+#include <LruCache.hpp>
+#include <functional>
+
+namespace
+{
+    const size_t kInitialSlots = 64;
+}
+
+LruCache::LruCache(size_t max_bytes)
+    : slots(kInitialSlots, kNil), max_bytes(max_bytes)
+{
+}
+
+size_t LruCache::Cost(const Node &node)
+{
+    return sizeof(Node) + 2 * sizeof(uint32_t) + node.key.size() + node.value.ByteSize();
+}
+
+size_t LruCache::FindSlot(const std::string &key, size_t hash) const
+{
+    const size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        const uint32_t node = slots[slot];
+        if (node == kNil || (nodes[node].hash == hash && nodes[node].key == key))
+            return slot;
+    }
+}
+
+void LruCache::Grow()
+{
+    std::vector<uint32_t> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, kNil);
+    const size_t mask = slots.size() - 1;
+    for (uint32_t node : old)
+    {
+        if (node == kNil)
+            continue;
+        size_t slot = nodes[node].hash & mask;
+        while (slots[slot] != kNil)
+            slot = (slot + 1) & mask;
+        slots[slot] = node;
+    }
+}
+
+void LruCache::Unlink(uint32_t node)
+{
+    Node &n = nodes[node];
+    if (n.prev != kNil)
+        nodes[n.prev].next = n.next;
+    else
+        head = n.next;
+    if (n.next != kNil)
+        nodes[n.next].prev = n.prev;
+    else
+        tail = n.prev;
+    n.prev = n.next = kNil;
+}
+
+void LruCache::PushFront(uint32_t node)
+{
+    Node &n = nodes[node];
+    n.prev = kNil;
+    n.next = head;
+    if (head != kNil)
+        nodes[head].prev = node;
+    head = node;
+    if (tail == kNil)
+        tail = node;
+}
+
+void LruCache::EraseSlot(size_t slot)
+{
+    // Backward-shift deletion keeps probe sequences intact without tombstones.
+    const size_t mask = slots.size() - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; slots[next] != kNil; next = (next + 1) & mask)
+    {
+        const size_t home = nodes[slots[next]].hash & mask;
+        const bool movable = (next > hole) ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable)
+        {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole] = kNil;
+}
+
+void LruCache::EvictToFit()
+{
+    while (used_bytes > max_bytes && tail != kNil)
+    {
+        const uint32_t victim = tail;
+        Node &n = nodes[victim];
+        EraseSlot(FindSlot(n.key, n.hash));
+        Unlink(victim);
+        used_bytes -= Cost(n);
+        --count;
+        std::string().swap(n.key);
+        n.value = TranslationResult();
+        free_nodes.push_back(victim);
+    }
+}
+
+bool LruCache::Lookup(const std::string &key, TranslationResult &value)
+{
+    const size_t hash = std::hash<std::string>()(key);
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint32_t node = slots[FindSlot(key, hash)];
+    if (node == kNil)
+    {
+        ++misses;
+        return false;
+    }
+    if (node != head)
+    {
+        Unlink(node);
+        PushFront(node);
+    }
+    value = nodes[node].value;
+    ++hits;
+    return true;
+}
+
+void LruCache::Store(const std::string &key, TranslationResult value)
+{
+    const size_t hash = std::hash<std::string>()(key);
+    std::lock_guard<std::mutex> lock(mutex);
+    const size_t slot = FindSlot(key, hash);
+    uint32_t node = slots[slot];
+    if (node != kNil)
+    {
+        Node &n = nodes[node];
+        used_bytes -= Cost(n);
+        n.value = std::move(value);
+        used_bytes += Cost(n);
+        Unlink(node);
+        PushFront(node);
+        EvictToFit();
+        return;
+    }
+
+    if (free_nodes.empty())
+    {
+        node = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    else
+    {
+        node = free_nodes.back();
+        free_nodes.pop_back();
+    }
+    Node &n = nodes[node];
+    n.key = key;
+    n.value = std::move(value);
+    n.hash = hash;
+    slots[slot] = node;
+    PushFront(node);
+    ++count;
+    used_bytes += Cost(n);
+
+    if (count * 2 > slots.size())
+        Grow();
+    EvictToFit();
+}
+
+void LruCache::setMaxBytes(size_t max_bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->max_bytes = max_bytes;
+    EvictToFit();
+}
+
+LruCache::Stats LruCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.entries = count;
+    stats.bytes = used_bytes;
+    return stats;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <TranslationResult.hpp>
+
+// Bounded in-memory LRU of recent translation results. Entries live in a
+// flat node array linked into the recency list by index, and are found
+// through a linear-probing table of node indices, so lookups touch a few
+// contiguous cache lines instead of chasing map and list nodes.
+class LruCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t entries = 0;
+        uint64_t bytes = 0;
+    };
+
+    explicit LruCache(size_t max_bytes);
+
+    bool Lookup(const std::string &key, TranslationResult &value);
+    void Store(const std::string &key, TranslationResult value);
+    void setMaxBytes(size_t max_bytes);
+    Stats GetStats() const;
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node
+    {
+        std::string key;
+        TranslationResult value;
+        size_t hash = 0;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+    };
+
+    size_t FindSlot(const std::string &key, size_t hash) const;
+    void Grow();
+    void Unlink(uint32_t node);
+    void PushFront(uint32_t node);
+    void EraseSlot(size_t slot);
+    void EvictToFit();
+    static size_t Cost(const Node &node);
+
+    mutable std::mutex mutex;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> free_nodes;
+    std::vector<uint32_t> slots; // Node index per slot, kNil when empty.
+    uint32_t head = kNil;
+    uint32_t tail = kNil;
+    size_t count = 0;
+    size_t used_bytes = 0;
+    size_t max_bytes;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
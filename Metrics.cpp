@@ -0,0 +1,191 @@
+#include <Metrics.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <json.hpp>
+using json = nlohmann::json;
+
+namespace
+{
+    const double kQuantiles[] = {0.5, 0.95, 0.99};
+
+    // Index of the highest set bit; v must be non-zero.
+    unsigned HighestBit(uint64_t v)
+    {
+        unsigned bit = 0;
+        for (unsigned shift = 32; shift > 0; shift >>= 1)
+        {
+            if (v >> shift)
+            {
+                v >>= shift;
+                bit += shift;
+            }
+        }
+        return bit;
+    }
+
+    double Seconds(uint64_t micros)
+    {
+        return static_cast<double>(micros) / 1e6;
+    }
+
+    uint64_t Load(const std::atomic<uint64_t> &counter)
+    {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    json HistogramJson(const Histogram &histogram)
+    {
+        return {{"count", histogram.Count()},
+                {"sum_us", histogram.Sum()},
+                {"p50_us", histogram.Percentile(0.5)},
+                {"p95_us", histogram.Percentile(0.95)},
+                {"p99_us", histogram.Percentile(0.99)}};
+    }
+
+    void WriteSummary(std::ostream &out, const char *name, const char *label, const char *value, const Histogram &histogram)
+    {
+        for (double q : kQuantiles)
+            out << name << '{' << label << "=\"" << value << "\",quantile=\"" << q << "\"} " << Seconds(histogram.Percentile(q)) << '\n';
+        out << name << "_sum{" << label << "=\"" << value << "\"} " << Seconds(histogram.Sum()) << '\n';
+        out << name << "_count{" << label << "=\"" << value << "\"} " << histogram.Count() << '\n';
+    }
+}
+
+size_t Histogram::BucketOf(uint64_t micros)
+{
+    if (micros < kLinear)
+        return static_cast<size_t>(micros);
+    const unsigned exponent = HighestBit(micros);
+    const size_t sub = static_cast<size_t>(micros >> (exponent - 3)) & (kSubBuckets - 1);
+    return kLinear + (exponent - 4) * kSubBuckets + sub;
+}
+
+uint64_t Histogram::BucketMidpoint(size_t bucket)
+{
+    if (bucket < kLinear)
+        return bucket;
+    const size_t offset = bucket - kLinear;
+    const unsigned shift = static_cast<unsigned>(offset / kSubBuckets) + 1;
+    const uint64_t lower = static_cast<uint64_t>(kSubBuckets + offset % kSubBuckets) << shift;
+    return lower + (uint64_t(1) << shift) / 2;
+}
+
+void Histogram::Record(uint64_t micros)
+{
+    buckets[BucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(micros, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Histogram::Record(std::chrono::steady_clock::duration elapsed)
+{
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    Record(static_cast<uint64_t>(std::max<decltype(micros)>(0, micros)));
+}
+
+uint64_t Histogram::Count() const
+{
+    return Load(count);
+}
+
+uint64_t Histogram::Sum() const
+{
+    return Load(sum);
+}
+
+uint64_t Histogram::Percentile(double p) const
+{
+    // Buckets are read one by one while writers keep going, so take the
+    // total from the same snapshot rather than from `count`.
+    uint64_t snapshot[kBuckets];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBuckets; ++i)
+    {
+        snapshot[i] = Load(buckets[i]);
+        total += snapshot[i];
+    }
+    if (total == 0)
+        return 0;
+    const double clamped = std::min(1.0, std::max(0.0, p));
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped * static_cast<double>(total) + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i)
+    {
+        seen += snapshot[i];
+        if (seen >= rank)
+            return BucketMidpoint(i);
+    }
+    return BucketMidpoint(kBuckets - 1);
+}
+
+std::string Metrics::ToJson() const
+{
+    json j = {
+        {"transfer", {{"dns", HistogramJson(dns)}, {"connect", HistogramJson(connect)}, {"tls", HistogramJson(tls)}, {"server", HistogramJson(server)}, {"total", HistogramJson(total)}}},
+        {"parse", {{"envelope", HistogramJson(envelope_parse)}, {"result", HistogramJson(result_parse)}}},
+        {"requests", Load(requests)},
+        {"new_connections", Load(new_connections)},
+        {"transport_errors", Load(transport_errors)},
+        {"http_errors", Load(http_errors)},
+        {"retries", Load(retries)},
+        {"hedged", Load(hedged)},
+        {"bytes_sent", Load(bytes_sent)},
+        {"bytes_received", Load(bytes_received)},
+        {"cache", {{"memory_hits", Load(memory_cache_hits)}, {"disk_hits", Load(disk_cache_hits)}, {"misses", Load(cache_misses)}}}};
+    return j.dump(2);
+}
+
+std::string Metrics::ToPrometheus() const
+{
+    std::ostringstream out;
+    out << std::setprecision(6);
+    out << "# HELP translatur_transfer_seconds Time spent in each phase of an API request.\n"
+           "# TYPE translatur_transfer_seconds summary\n";
+    WriteSummary(out, "translatur_transfer_seconds", "phase", "dns", dns);
+    WriteSummary(out, "translatur_transfer_seconds", "phase", "connect", connect);
+    WriteSummary(out, "translatur_transfer_seconds", "phase", "tls", tls);
+    WriteSummary(out, "translatur_transfer_seconds", "phase", "server", server);
+    WriteSummary(out, "translatur_transfer_seconds", "phase", "total", total);
+    out << "# HELP translatur_parse_seconds Time spent parsing API responses.\n"
+           "# TYPE translatur_parse_seconds summary\n";
+    WriteSummary(out, "translatur_parse_seconds", "stage", "envelope", envelope_parse);
+    WriteSummary(out, "translatur_parse_seconds", "stage", "result", result_parse);
+    out << "# TYPE translatur_requests_total counter\n"
+        << "translatur_requests_total " << Load(requests) << '\n'
+        << "# TYPE translatur_new_connections_total counter\n"
+        << "translatur_new_connections_total " << Load(new_connections) << '\n'
+        << "# TYPE translatur_errors_total counter\n"
+        << "translatur_errors_total{kind=\"transport\"} " << Load(transport_errors) << '\n'
+        << "translatur_errors_total{kind=\"http\"} " << Load(http_errors) << '\n'
+        << "# TYPE translatur_retries_total counter\n"
+        << "translatur_retries_total " << Load(retries) << '\n'
+        << "# TYPE translatur_hedged_requests_total counter\n"
+        << "translatur_hedged_requests_total " << Load(hedged) << '\n'
+        << "# TYPE translatur_bytes_total counter\n"
+        << "translatur_bytes_total{direction=\"sent\"} " << Load(bytes_sent) << '\n'
+        << "translatur_bytes_total{direction=\"received\"} " << Load(bytes_received) << '\n'
+        << "# TYPE translatur_cache_lookups_total counter\n"
+        << "translatur_cache_lookups_total{result=\"memory_hit\"} " << Load(memory_cache_hits) << '\n'
+        << "translatur_cache_lookups_total{result=\"disk_hit\"} " << Load(disk_cache_hits) << '\n'
+        << "translatur_cache_lookups_total{result=\"miss\"} " << Load(cache_misses) << '\n';
+    return out.str();
+}
+
+bool Metrics::WriteFile(const std::string &path) const
+{
+    const bool as_json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open())
+            return false;
+        out << (as_json ? ToJson() : ToPrometheus());
+        if (!out)
+            return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Latency histogram that can be recorded into from any thread without a
+// lock. Values are microseconds, bucketed log-linearly: exact below 16,
+// then eight buckets per power of two, so a percentile is off by at most
+// one eighth of its value.
+class Histogram
+{
+public:
+    void Record(uint64_t micros);
+    void Record(std::chrono::steady_clock::duration elapsed);
+    uint64_t Count() const;
+    uint64_t Sum() const;
+    // Midpoint of the bucket holding the p-th sample (p in [0, 1]), or 0
+    // if nothing was recorded.
+    uint64_t Percentile(double p) const;
+
+private:
+    static constexpr size_t kLinear = 16;
+    static constexpr size_t kSubBuckets = 8;
+    static constexpr size_t kBuckets = kLinear + (64 - 4) * kSubBuckets;
+
+    static size_t BucketOf(uint64_t micros);
+    static uint64_t BucketMidpoint(size_t bucket);
+
+    std::atomic<uint64_t> buckets[kBuckets] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+};
+
+// Per-request timings and counters for one Translator. Transfer phases come
+// from curl: `dns`, `connect` and `tls` are only recorded for requests that
+// opened a new connection (through the proxy, if one is set), `server` is
+// the wait between sending the request and the first response byte, and
+// `total` covers the whole transfer. Parse times cover extracting the text
+// from the API envelope and parsing the result JSON.
+struct Metrics
+{
+    Histogram dns;
+    Histogram connect;
+    Histogram tls;
+    Histogram server;
+    Histogram total;
+    Histogram envelope_parse;
+    Histogram result_parse;
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> new_connections{0};
+    std::atomic<uint64_t> transport_errors{0};
+    std::atomic<uint64_t> http_errors{0};
+    std::atomic<uint64_t> retries{0};
+    std::atomic<uint64_t> hedged{0};
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<uint64_t> bytes_received{0};
+    std::atomic<uint64_t> memory_cache_hits{0};
+    std::atomic<uint64_t> disk_cache_hits{0};
+    std::atomic<uint64_t> cache_misses{0};
+
+    std::string ToJson() const;
+    // Prometheus text exposition format; histograms become summaries with
+    // 0.5, 0.95 and 0.99 quantiles in seconds.
+    std::string ToPrometheus() const;
+    // JSON if the path ends in ".json", Prometheus text otherwise. Written
+    // to a temporary file and renamed so scrapers never see half a file.
+    bool WriteFile(const std::string &path) const;
+};
@@ -0,0 +1,317 @@
+#include <MockServer.hpp>
+#include <algorithm>
+#include <charconv>
+#include <json.hpp>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define CLOSE_SOCKET closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+#define CLOSE_SOCKET close
+#endif
+
+using json = nlohmann::json;
+
+namespace
+{
+    const char *const kDefaultModelText =
+        "{\"type\": \"word\", \"word\": \"mock\", \"definition\": \"A canned response from the local mock server.\", "
+        "\"examples\": [\"This is a mock example.\"], \"pronunciation\": \"/m\\u0251k/\", "
+        "\"persian_definition\": \"\\u067e\\u0627\\u0633\\u062e \\u0622\\u0632\\u0645\\u0627\\u06cc\\u0634\\u06cc\", "
+        "\"synonyms\": [\"fake\"], \"acronym\": \"\"}";
+    const size_t kStreamChunks = 3;
+    // Pause after a failed accept() (out of descriptors, say) instead of
+    // spinning on the same error.
+    const std::chrono::milliseconds kAcceptRetryDelay(50);
+    const char *const kBadRequest = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+    std::string Envelope(const std::string &text)
+    {
+        json envelope = {
+            {"candidates", {{{"content", {{"parts", {{{"text", text}}}}, {"role", "model"}}}, {"finishReason", "STOP"}}}}};
+        return envelope.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+
+    // Batch prompts (see BuildBatchPrompt) ask for an array and end with the
+    // inputs as a JSON array. Returns how many inputs, or 0 for any other
+    // request.
+    size_t BatchSize(const std::string &body)
+    {
+        if (body.find("\"ARRAY\"") == std::string::npos)
+            return 0;
+        const json request = json::parse(body, nullptr, false);
+        const json::json_pointer type("/generationConfig/responseSchema/type");
+        const json::json_pointer text("/contents/0/parts/0/text");
+        if (request.is_discarded() || !request.contains(type) || request[type] != "ARRAY" ||
+            !request.contains(text) || !request[text].is_string())
+            return 0;
+        const std::string &prompt = request[text].get_ref<const std::string &>();
+        const std::string marker = "\nInputs: ";
+        const size_t inputs = prompt.rfind(marker);
+        if (inputs == std::string::npos)
+            return 0;
+        const json items = json::parse(prompt.substr(inputs + marker.size()), nullptr, false);
+        return items.is_array() ? items.size() : 0;
+    }
+
+    bool SendAll(socket_t s, const std::string &data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            int n = send(s, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+            if (n <= 0)
+                return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+MockServer::MockServer(std::chrono::milliseconds latency)
+    : latency_ms(latency.count())
+{
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+}
+
+MockServer::~MockServer()
+{
+    Stop();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool MockServer::Start()
+{
+    socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s == static_cast<socket_t>(-1))
+        return false;
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&yes), sizeof(yes));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(s, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(s, 64) != 0 ||
+        getsockname(s, reinterpret_cast<sockaddr *>(&addr), &len) != 0)
+    {
+        CLOSE_SOCKET(s);
+        return false;
+    }
+
+    listener = static_cast<long long>(s);
+    port = ntohs(addr.sin_port);
+    running = true;
+    acceptor = std::thread(&MockServer::AcceptLoop, this);
+    return true;
+}
+
+void MockServer::Stop()
+{
+    if (!running.exchange(false))
+        return;
+    shutdown(static_cast<socket_t>(listener), 2);
+    CLOSE_SOCKET(static_cast<socket_t>(listener));
+    if (acceptor.joinable())
+        acceptor.join();
+
+    std::vector<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (long long client : clients)
+            shutdown(static_cast<socket_t>(client), 2);
+        finished.swap(threads);
+    }
+    for (std::thread &thread : finished)
+        thread.join();
+}
+
+void MockServer::setLatency(std::chrono::milliseconds latency)
+{
+    latency_ms = latency.count();
+}
+
+void MockServer::AddResponse(std::string model_text)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    responses.push_back(std::move(model_text));
+}
+
+std::string MockServer::NextModelText(const std::string &body)
+{
+    const unsigned long long n = requests++;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!responses.empty())
+            return responses[n % responses.size()];
+    }
+    const size_t batch = BatchSize(body);
+    if (batch == 0)
+        return kDefaultModelText;
+    std::string text = "[";
+    for (size_t i = 0; i < batch; ++i)
+        text += (i ? ", " : "") + std::string(kDefaultModelText);
+    return text + "]";
+}
+
+void MockServer::AcceptLoop()
+{
+    while (running)
+    {
+        socket_t client = accept(static_cast<socket_t>(listener), nullptr, nullptr);
+        if (client == static_cast<socket_t>(-1))
+        {
+            if (running)
+                std::this_thread::sleep_for(kAcceptRetryDelay);
+            continue;
+        }
+        int yes = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&yes), sizeof(yes));
+
+        // Join the threads of connections that have closed, so a long run
+        // with short-lived connections does not keep one per connection.
+        std::vector<std::thread> done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running)
+            {
+                CLOSE_SOCKET(client);
+                break;
+            }
+            for (auto it = threads.begin(); it != threads.end();)
+            {
+                if (std::find(finished.begin(), finished.end(), it->get_id()) != finished.end())
+                {
+                    done.push_back(std::move(*it));
+                    it = threads.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            finished.clear();
+            clients.push_back(static_cast<long long>(client));
+            threads.emplace_back(&MockServer::Serve, this, static_cast<long long>(client));
+        }
+        for (std::thread &thread : done)
+            thread.join();
+    }
+}
+
+void MockServer::Serve(long long client_handle)
+{
+    std::string buffer;
+    while (running && ServeOne(client_handle, buffer))
+    {
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = clients.begin(); it != clients.end(); ++it)
+    {
+        if (*it == client_handle)
+        {
+            clients.erase(it);
+            break;
+        }
+    }
+    CLOSE_SOCKET(static_cast<socket_t>(client_handle));
+    finished.push_back(std::this_thread::get_id());
+}
+
+bool MockServer::ServeOne(long long client_handle, std::string &buffer)
+{
+    const socket_t client = static_cast<socket_t>(client_handle);
+    char chunk[4096];
+    size_t header_end;
+    while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos)
+    {
+        int n = recv(client, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+            return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+
+    size_t content_length = 0;
+    const std::string headers = buffer.substr(0, header_end);
+    for (size_t pos = 0; pos < headers.size();)
+    {
+        size_t eol = headers.find("\r\n", pos);
+        std::string line = headers.substr(pos, eol == std::string::npos ? std::string::npos : eol - pos);
+        if (line.size() > 15 && (line.compare(0, 15, "Content-Length:") == 0 || line.compare(0, 15, "content-length:") == 0))
+        {
+            const char *end = line.data() + line.size();
+            const char *digits = line.data() + 15;
+            while (digits != end && (*digits == ' ' || *digits == '\t'))
+                ++digits;
+            const auto parsed = std::from_chars(digits, end, content_length);
+            if (digits == end || parsed.ec != std::errc() || parsed.ptr != end)
+            {
+                SendAll(client, kBadRequest);
+                return false;
+            }
+        }
+        if (eol == std::string::npos)
+            break;
+        pos = eol + 2;
+    }
+    const bool stream = headers.find(":streamGenerateContent") != std::string::npos;
+
+    while (buffer.size() < header_end + 4 + content_length)
+    {
+        int n = recv(client, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+            return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    const std::string text = NextModelText(buffer.substr(header_end + 4, content_length));
+    buffer.erase(0, header_end + 4 + content_length);
+
+    const long long latency = latency_ms;
+    if (!stream)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(latency));
+        const std::string body = Envelope(text);
+        return SendAll(client, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                                   std::to_string(body.size()) + "\r\n\r\n" + body);
+    }
+
+    // Split the text into a few SSE events spread across the latency. Cuts
+    // move forward to the next code point, since every event carries valid
+    // UTF-8 text.
+    std::vector<std::string> events;
+    size_t total = 0;
+    const size_t piece = text.size() / kStreamChunks + 1;
+    for (size_t pos = 0, end; pos < text.size(); pos = end)
+    {
+        end = std::min(pos + piece, text.size());
+        while (end < text.size() && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80)
+            ++end;
+        events.push_back("data: " + Envelope(text.substr(pos, end - pos)) + "\r\n\r\n");
+        total += events.back().size();
+    }
+    if (!SendAll(client, "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nContent-Length: " +
+                             std::to_string(total) + "\r\n\r\n"))
+        return false;
+    for (const std::string &event : events)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(latency / static_cast<long long>(events.size())));
+        if (!SendAll(client, event))
+            return false;
+    }
+    return true;
+}
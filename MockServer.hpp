@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal HTTP/1.1 server on 127.0.0.1 that answers every generateContent
+// or streamGenerateContent call with a canned Gemini response after a
+// fixed delay. Responses are replayed round-robin, so runs are repeatable.
+// Without added responses, batch prompts get one default result per input.
+class MockServer
+{
+public:
+    explicit MockServer(std::chrono::milliseconds latency = std::chrono::milliseconds(0));
+    ~MockServer();
+    MockServer(const MockServer &) = delete;
+    MockServer &operator=(const MockServer &) = delete;
+
+    // Binds an ephemeral port and starts accepting; returns false on error.
+    bool Start();
+    void Stop();
+    int Port() const { return port; }
+
+    void setLatency(std::chrono::milliseconds latency);
+    // Adds model text (the JSON the model would generate) to the replay list.
+    void AddResponse(std::string model_text);
+    unsigned long long RequestCount() const { return requests; }
+
+private:
+    void AcceptLoop();
+    void Serve(long long client);
+    bool ServeOne(long long client, std::string &buffer);
+    std::string NextModelText(const std::string &body);
+
+    long long listener = -1;
+    int port = 0;
+    std::atomic<bool> running{false};
+    std::atomic<long long> latency_ms;
+    std::atomic<unsigned long long> requests{0};
+
+    std::mutex mutex;
+    std::vector<std::string> responses;
+    std::vector<long long> clients;
+    std::vector<std::thread> threads;
+    // Serving threads that have returned and can be joined.
+    std::vector<std::thread::id> finished;
+    std::thread acceptor;
+};
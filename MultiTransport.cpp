@@ -0,0 +1,111 @@
+#include <MultiTransport.hpp>
+#include <future>
+#include <memory>
+#include <unordered_map>
+
+namespace
+{
+    // curl_multi_poll also returns when a transfer's own timeout is due or
+    // Start wakes it, so this only bounds how long an idle loop sleeps.
+    const int kPollTimeoutMs = 1000;
+    // Idle connections kept open for reuse. With HTTP/2 one connection per
+    // host carries every concurrent lookup; the rest is for HTTP/1.1
+    // servers such as MockServer and proxies without HTTP/2.
+    const long kMaxCachedConnections = 64;
+}
+
+MultiTransport::MultiTransport()
+{
+    multi = curl_multi_init();
+    if (!multi)
+        return;
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, kMaxCachedConnections);
+    loop = std::thread(&MultiTransport::Loop, this);
+}
+
+MultiTransport::~MultiTransport()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    if (multi)
+        curl_multi_wakeup(multi);
+    if (loop.joinable())
+        loop.join();
+    if (multi)
+        curl_multi_cleanup(multi);
+}
+
+void MultiTransport::Start(CURL *curl, Completion done)
+{
+    if (!multi)
+    {
+        done(CURLE_FAILED_INIT);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        incoming.push_back(Transfer{curl, std::move(done)});
+    }
+    curl_multi_wakeup(multi);
+}
+
+CURLcode MultiTransport::Perform(CURL *curl)
+{
+    // Shared so the loop thread never touches a promise the caller has
+    // already dropped.
+    auto finished = std::make_shared<std::promise<CURLcode>>();
+    std::future<CURLcode> result = finished->get_future();
+    Start(curl, [finished](CURLcode code)
+          { finished->set_value(code); });
+    return result.get();
+}
+
+void MultiTransport::Loop()
+{
+    std::unordered_map<CURL *, Completion> active;
+    std::vector<Transfer> added;
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            added.swap(incoming);
+            // Stopping lets running transfers finish first; their owners
+            // are blocked waiting for them.
+            if (stopping && added.empty() && active.empty())
+                return;
+        }
+        for (Transfer &transfer : added)
+        {
+            if (curl_multi_add_handle(multi, transfer.curl) != CURLM_OK)
+            {
+                transfer.done(CURLE_FAILED_INIT);
+                continue;
+            }
+            active.emplace(transfer.curl, std::move(transfer.done));
+        }
+        added.clear();
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+        int queued = 0;
+        while (CURLMsg *message = curl_multi_info_read(multi, &queued))
+        {
+            if (message->msg != CURLMSG_DONE)
+                continue;
+            CURL *curl = message->easy_handle;
+            const CURLcode result = message->data.result;
+            curl_multi_remove_handle(multi, curl);
+            auto it = active.find(curl);
+            if (it == active.end())
+                continue;
+            Completion done = std::move(it->second);
+            active.erase(it);
+            done(result);
+        }
+
+        curl_multi_poll(multi, nullptr, 0, kPollTimeoutMs, nullptr);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <curl/curl.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs transfers on one curl multi handle driven by a single event loop
+// thread. All transfers share the multi handle's connection cache, and
+// HTTPS requests are multiplexed as HTTP/2 streams over the connections
+// already open to a host, so many concurrent lookups need only a few
+// sockets. The handle's callbacks (write, progress) run on the loop thread.
+class MultiTransport
+{
+public:
+    using Completion = std::function<void(CURLcode result)>;
+
+    MultiTransport();
+    // Waits for transfers still running.
+    ~MultiTransport();
+    MultiTransport(const MultiTransport &) = delete;
+    MultiTransport &operator=(const MultiTransport &) = delete;
+
+    // Starts a configured easy handle; `done` runs on the loop thread once
+    // it finishes. The handle must stay alive and untouched until then.
+    // Used where one caller drives several transfers at once, as hedged
+    // lookups do.
+    void Start(CURL *curl, Completion done);
+    // Like Start, but blocks the caller until the transfer finishes. Each
+    // waiting caller still occupies its own thread; what the loop saves is
+    // connections, not threads.
+    CURLcode Perform(CURL *curl);
+
+private:
+    struct Transfer
+    {
+        CURL *curl;
+        Completion done;
+    };
+
+    void Loop();
+
+    CURLM *multi = nullptr;
+    std::mutex mutex;
+    std::vector<Transfer> incoming;
+    bool stopping = false;
+    std::thread loop;
+};
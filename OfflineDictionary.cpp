@@ -0,0 +1,253 @@
+#include <OfflineDictionary.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char kFileMagic[4] = {'T', 'R', 'D', '1'};
+    const size_t kHeaderSize = 16;
+    const size_t kRecordHeaderSize = 8;
+    // Average keys per bucket, and keys per slot. Looser tables build faster
+    // but take more space; these settle in well under a second for 100k words.
+    const uint32_t kBucketLoad = 4;
+    const double kSlotLoad = 0.8;
+    const uint32_t kMaxSeed = 1u << 24;
+
+    uint64_t HashKey(std::string_view key)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : key)
+            hash = (hash ^ c) * 1099511628211ull;
+        return hash;
+    }
+
+    // splitmix64 finalizer, so one FNV hash yields independent values per seed.
+    uint64_t Mix(uint64_t hash, uint32_t seed)
+    {
+        uint64_t z = hash + (static_cast<uint64_t>(seed) + 1) * 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    void PutU32(char *out, uint32_t v)
+    {
+        out[0] = static_cast<char>(v & 0xff);
+        out[1] = static_cast<char>((v >> 8) & 0xff);
+        out[2] = static_cast<char>((v >> 16) & 0xff);
+        out[3] = static_cast<char>((v >> 24) & 0xff);
+    }
+
+    uint32_t GetU32(const char *in)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(in);
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+}
+
+OfflineDictionary::~OfflineDictionary()
+{
+    Close();
+}
+
+bool OfflineDictionary::Open(const std::string &path)
+{
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    HANDLE mapping = nullptr;
+    const void *view = nullptr;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_handle = file;
+    mapping_handle = mapping;
+    data = static_cast<const char *>(view);
+    size = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void *view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+    data = static_cast<const char *>(view);
+    size = static_cast<size_t>(st.st_size);
+#endif
+
+    if (size < kHeaderSize || !std::equal(kFileMagic, kFileMagic + sizeof(kFileMagic), data))
+    {
+        Close();
+        return false;
+    }
+    entries = GetU32(data + 4);
+    buckets = GetU32(data + 8);
+    slots = GetU32(data + 12);
+    if (buckets == 0 || slots == 0 || kHeaderSize + 4 * (static_cast<uint64_t>(buckets) + slots) > size)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void OfflineDictionary::Close()
+{
+    if (!data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+    CloseHandle(static_cast<HANDLE>(file_handle));
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    munmap(const_cast<char *>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    entries = buckets = slots = 0;
+}
+
+bool OfflineDictionary::Lookup(std::string_view word, std::string &persian) const
+{
+    if (!data)
+        return false;
+    const uint64_t hash = HashKey(word);
+    const uint32_t seed = GetU32(data + kHeaderSize + 4 * (Mix(hash, 0) % buckets));
+    const uint32_t offset = GetU32(data + kHeaderSize + 4 * (static_cast<uint64_t>(buckets) + Mix(hash, seed + 1) % slots));
+    if (offset == 0 || offset > size - kRecordHeaderSize)
+        return false;
+    const uint32_t key_length = GetU32(data + offset);
+    const uint32_t value_length = GetU32(data + offset + 4);
+    const uint64_t end = static_cast<uint64_t>(offset) + kRecordHeaderSize + key_length + value_length;
+    if (end > size || key_length != word.size() || std::memcmp(data + offset + kRecordHeaderSize, word.data(), key_length) != 0)
+        return false;
+    persian.assign(data + offset + kRecordHeaderSize + key_length, value_length);
+    return true;
+}
+
+bool OfflineDictionary::Build(std::vector<std::pair<std::string, std::string>> words, const std::string &path)
+{
+    // Keep the last value for each key.
+    std::unordered_map<std::string, size_t> latest;
+    for (size_t i = 0; i < words.size(); ++i)
+        latest[words[i].first] = i;
+    std::vector<std::pair<std::string, std::string>> unique;
+    unique.reserve(latest.size());
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        auto it = latest.find(words[i].first);
+        if (it != latest.end() && it->second == i)
+            unique.push_back(std::move(words[i]));
+    }
+
+    const uint32_t count = static_cast<uint32_t>(unique.size());
+    const uint32_t bucket_count = std::max<uint32_t>(1, (count + kBucketLoad - 1) / kBucketLoad);
+    const uint32_t slot_count = std::max<uint32_t>(1, static_cast<uint32_t>(count / kSlotLoad) + 1);
+
+    std::vector<uint64_t> hashes(count);
+    std::vector<std::vector<uint32_t>> members(bucket_count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        hashes[i] = HashKey(unique[i].first);
+        members[Mix(hashes[i], 0) % bucket_count].push_back(i);
+    }
+    std::vector<uint32_t> order(bucket_count);
+    for (uint32_t b = 0; b < bucket_count; ++b)
+        order[b] = b;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+              { return members[a].size() > members[b].size(); });
+
+    // Place the largest buckets first while the table is still empty.
+    std::vector<uint32_t> seeds(bucket_count, 0);
+    std::vector<int64_t> slot_entry(slot_count, -1);
+    std::vector<uint32_t> placed;
+    for (uint32_t b : order)
+    {
+        if (members[b].empty())
+            break;
+        uint32_t seed = 0;
+        for (;; ++seed)
+        {
+            if (seed == kMaxSeed)
+                return false;
+            placed.clear();
+            bool fits = true;
+            for (uint32_t i : members[b])
+            {
+                const uint32_t slot = static_cast<uint32_t>(Mix(hashes[i], seed + 1) % slot_count);
+                if (slot_entry[slot] >= 0 || std::find(placed.begin(), placed.end(), slot) != placed.end())
+                {
+                    fits = false;
+                    break;
+                }
+                placed.push_back(slot);
+            }
+            if (fits)
+                break;
+        }
+        seeds[b] = seed;
+        for (size_t k = 0; k < placed.size(); ++k)
+            slot_entry[placed[k]] = members[b][k];
+    }
+
+    std::string out(kHeaderSize + 4 * (static_cast<size_t>(bucket_count) + slot_count), '\0');
+    std::copy(kFileMagic, kFileMagic + sizeof(kFileMagic), &out[0]);
+    PutU32(&out[4], count);
+    PutU32(&out[8], bucket_count);
+    PutU32(&out[12], slot_count);
+    for (uint32_t b = 0; b < bucket_count; ++b)
+        PutU32(&out[kHeaderSize + 4 * b], seeds[b]);
+    for (uint32_t s = 0; s < slot_count; ++s)
+    {
+        if (slot_entry[s] < 0)
+            continue;
+        const auto &entry = unique[static_cast<size_t>(slot_entry[s])];
+        if (out.size() + kRecordHeaderSize + entry.first.size() + entry.second.size() > UINT32_MAX)
+            return false;
+        PutU32(&out[kHeaderSize + 4 * (static_cast<size_t>(bucket_count) + s)], static_cast<uint32_t>(out.size()));
+        char header[kRecordHeaderSize];
+        PutU32(header, static_cast<uint32_t>(entry.first.size()));
+        PutU32(header + 4, static_cast<uint32_t>(entry.second.size()));
+        out.append(header, sizeof(header));
+        out += entry.first;
+        out += entry.second;
+    }
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file.write(out.data(), static_cast<std::streamsize>(out.size())))
+            return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Read-only English to Persian word list, memory-mapped from a file built by
+// translatur-dictimport. Keys are NormalizeKey()ed words; a perfect hash
+// (hash and displace) maps each key to its own slot, with about a fifth of
+// the slots left empty, so a lookup hashes the key twice and compares at
+// most one record.
+//
+// File layout, little-endian:
+//   "TRD1" | u32 entries | u32 buckets | u32 slots
+//   u32 seed per bucket | u32 record offset per slot (0 = empty)
+//   records: u32 key length | u32 value length | key | value
+class OfflineDictionary
+{
+public:
+    OfflineDictionary() = default;
+    ~OfflineDictionary();
+    OfflineDictionary(const OfflineDictionary &) = delete;
+    OfflineDictionary &operator=(const OfflineDictionary &) = delete;
+
+    bool Open(const std::string &path);
+    void Close();
+    bool IsOpen() const { return data != nullptr; }
+    size_t Size() const { return entries; }
+    // `word` must already be normalized.
+    bool Lookup(std::string_view word, std::string &persian) const;
+
+    // Writes a dictionary file; later duplicates of a key replace earlier
+    // ones. Returns false if the file cannot be written.
+    static bool Build(std::vector<std::pair<std::string, std::string>> words, const std::string &path);
+
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+    uint32_t entries = 0;
+    uint32_t buckets = 0;
+    uint32_t slots = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+};
@@ -0,0 +1,124 @@
+#include <PromptProfile.hpp>
+#include <json.hpp>
+using json = nlohmann::json;
+
+namespace
+{
+    const int kProfileCount = 3;
+
+    const char *const kNames[kProfileCount] = {"persian-only", "full-dictionary", "sentence"};
+
+    // Instructions are kept short; the schema already names every field.
+    const char *const kInstructions[kProfileCount] = {
+        "Translate into Persian. Set type to \"word\" for a single word or term, otherwise \"sentence\".",
+        "Give an English dictionary entry and a Persian translation. Set type to \"word\" for a single word or term, "
+        "otherwise \"sentence\" and leave the word-only fields empty. pronunciation is IPA; acronym is the full form "
+        "if the input is an acronym, otherwise empty.",
+        "Translate into natural Persian, keeping the tone of the original."};
+
+    json StringSchema()
+    {
+        return {{"type", "STRING"}};
+    }
+
+    json ListSchema()
+    {
+        return {{"type", "ARRAY"}, {"items", StringSchema()}};
+    }
+
+    // persian_definition comes first so streamed answers show the
+    // translation before anything else.
+    json ItemSchema(PromptProfile profile)
+    {
+        json properties = {{"persian_definition", StringSchema()}};
+        json order = {"persian_definition"};
+        if (profile != PromptProfile::Sentence)
+        {
+            properties["type"] = {{"type", "STRING"}, {"enum", {"word", "sentence"}}};
+            order.push_back("type");
+        }
+        if (profile == PromptProfile::FullDictionary)
+        {
+            for (const char *field : {"definition", "pronunciation", "acronym"})
+            {
+                properties[field] = StringSchema();
+                order.push_back(field);
+            }
+            for (const char *field : {"examples", "synonyms"})
+            {
+                properties[field] = ListSchema();
+                order.push_back(field);
+            }
+        }
+        return {{"type", "OBJECT"}, {"properties", properties}, {"required", order}, {"propertyOrdering", order}};
+    }
+
+    struct Schemas
+    {
+        std::string single[kProfileCount];
+        std::string batch[kProfileCount];
+
+        Schemas()
+        {
+            for (int i = 0; i < kProfileCount; ++i)
+            {
+                json item = ItemSchema(static_cast<PromptProfile>(i));
+                single[i] = item.dump();
+                batch[i] = json{{"type", "ARRAY"}, {"items", item}}.dump();
+            }
+        }
+    };
+
+    const Schemas &GetSchemas()
+    {
+        static const Schemas schemas;
+        return schemas;
+    }
+}
+
+const char *PromptProfileName(PromptProfile profile)
+{
+    return kNames[static_cast<int>(profile)];
+}
+
+bool ParsePromptProfile(const std::string &name, PromptProfile &profile)
+{
+    for (int i = 0; i < kProfileCount; ++i)
+    {
+        if (name == kNames[i])
+        {
+            profile = static_cast<PromptProfile>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+Prompt BuildPrompt(PromptProfile profile, const std::string &text)
+{
+    const int index = static_cast<int>(profile);
+    Prompt prompt;
+    prompt.text = std::string(kInstructions[index]) + "\nInput: " +
+                  json(text).dump(-1, ' ', false, json::error_handler_t::replace);
+    prompt.response_schema = GetSchemas().single[index];
+    return prompt;
+}
+
+Prompt BuildBatchPrompt(PromptProfile profile, const std::vector<std::string> &texts)
+{
+    const int index = static_cast<int>(profile);
+    Prompt prompt;
+    prompt.text = std::string("For each of the ") + std::to_string(texts.size()) +
+                  " inputs, in order, return one result. " + kInstructions[index] + "\nInputs: " +
+                  json(texts).dump(-1, ' ', false, json::error_handler_t::replace);
+    prompt.response_schema = GetSchemas().batch[index];
+    return prompt;
+}
+
+void CompleteResult(PromptProfile profile, const std::string &text, TranslationResult &result)
+{
+    if (result.word.empty())
+        result.word = text;
+    if (profile == PromptProfile::Sentence && result.type.empty())
+        result.type = "sentence";
+}
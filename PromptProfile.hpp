@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <TranslationResult.hpp>
+
+// Which fields a lookup asks the model for. Smaller profiles mean shorter
+// prompts and shorter answers, and so lower latency and cost.
+enum class PromptProfile
+{
+    PersianOnly,    // type and persian_definition; what the GUI shows
+    FullDictionary, // every TranslationResult field
+    Sentence        // persian_definition only, phrased for running text
+};
+
+// A prompt plus the JSON schema the reply must follow. The schema is sent
+// as Gemini's responseSchema with responseMimeType application/json, so the
+// reply is bare JSON without a code fence.
+struct Prompt
+{
+    std::string text;
+    std::string_view response_schema;
+};
+
+// Config names: "persian-only", "full-dictionary" and "sentence".
+const char *PromptProfileName(PromptProfile profile);
+bool ParsePromptProfile(const std::string &name, PromptProfile &profile);
+
+Prompt BuildPrompt(PromptProfile profile, const std::string &text);
+// Asks for a JSON array with one result per input, in input order.
+Prompt BuildBatchPrompt(PromptProfile profile, const std::vector<std::string> &texts);
+// Fills fields the profile leaves to the client instead of the model.
+void CompleteResult(PromptProfile profile, const std::string &text, TranslationResult &result);
@@ -0,0 +1,150 @@
+#include <RateLimiter.hpp>
+#include <algorithm>
+
+namespace
+{
+    // Buckets hold ten seconds' worth of quota, so an idle key can burst a
+    // little without a full minute's allowance landing at once.
+    const double kBurstSeconds = 10.0;
+    const std::chrono::milliseconds kPollInterval(50);
+    const std::chrono::seconds kMinBackoff(1);
+
+    double Capacity(double per_minute)
+    {
+        return std::max(1.0, per_minute * kBurstSeconds / 60.0);
+    }
+
+    std::chrono::steady_clock::duration SecondsToDuration(double seconds)
+    {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    }
+}
+
+void RateLimiter::setLimits(const Limits &limits)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->limits = limits;
+    for (auto &entry : buckets)
+    {
+        entry.second.requests = std::min(entry.second.requests, Capacity(limits.requests_per_minute));
+        entry.second.tokens = std::min(entry.second.tokens, Capacity(limits.tokens_per_minute));
+    }
+    cv.notify_all();
+}
+
+bool RateLimiter::Acquire(const std::string &key, size_t tokens, RequestClass request_class, const std::function<bool()> &cancelled)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (limits.requests_per_minute <= 0 && limits.tokens_per_minute <= 0 && buckets.empty())
+        return true;
+
+    const size_t slot = static_cast<size_t>(request_class);
+    Bucket &bucket = BucketFor(key, Clock::now());
+    bool waited = false;
+    ++bucket.waiting[slot];
+    for (;;)
+    {
+        Clock::duration wait;
+        if (TryTake(bucket, tokens, request_class, wait))
+        {
+            --bucket.waiting[slot];
+            if (waited)
+                ++throttled;
+            cv.notify_all();
+            return true;
+        }
+        if (cancelled && cancelled())
+        {
+            --bucket.waiting[slot];
+            cv.notify_all();
+            return false;
+        }
+        waited = true;
+        cv.wait_for(lock, std::min<Clock::duration>(wait, kPollInterval));
+    }
+}
+
+bool RateLimiter::TryAcquire(const std::string &key, size_t tokens, RequestClass request_class)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (limits.requests_per_minute <= 0 && limits.tokens_per_minute <= 0 && buckets.empty())
+        return true;
+    Clock::duration wait;
+    return TryTake(BucketFor(key, Clock::now()), tokens, request_class, wait);
+}
+
+bool RateLimiter::TryTake(Bucket &bucket, size_t tokens, RequestClass request_class, Clock::duration &wait)
+{
+    const Clock::time_point now = Clock::now();
+    Refill(bucket, now);
+    // A prompt larger than the whole bucket would otherwise never fit.
+    const double need = limits.tokens_per_minute > 0 ? std::min<double>(tokens, Capacity(limits.tokens_per_minute)) : 0;
+    if (request_class == RequestClass::Bulk && bucket.waiting[static_cast<size_t>(RequestClass::Interactive)] > 0)
+    {
+        wait = kPollInterval;
+        return false;
+    }
+    wait = TimeUntilReady(bucket, need, now);
+    if (wait > Clock::duration::zero())
+        return false;
+    if (limits.requests_per_minute > 0)
+        bucket.requests -= 1;
+    bucket.tokens -= need;
+    return true;
+}
+
+void RateLimiter::Backoff(const std::string &key, std::chrono::milliseconds delay)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point now = Clock::now();
+    Bucket &bucket = BucketFor(key, now);
+    bucket.requests = 0;
+    bucket.blocked_until = std::max(bucket.blocked_until, now + std::max<Clock::duration>(delay, kMinBackoff));
+}
+
+RateLimiter::Stats RateLimiter::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    for (const auto &entry : buckets)
+    {
+        stats.interactive_waiting += entry.second.waiting[static_cast<size_t>(RequestClass::Interactive)];
+        stats.bulk_waiting += entry.second.waiting[static_cast<size_t>(RequestClass::Bulk)];
+    }
+    stats.throttled = throttled;
+    return stats;
+}
+
+RateLimiter::Bucket &RateLimiter::BucketFor(const std::string &key, Clock::time_point now)
+{
+    auto it = buckets.find(key);
+    if (it == buckets.end())
+    {
+        Bucket bucket;
+        bucket.requests = Capacity(limits.requests_per_minute);
+        bucket.tokens = Capacity(limits.tokens_per_minute);
+        bucket.refilled = now;
+        it = buckets.emplace(key, bucket).first;
+    }
+    return it->second;
+}
+
+void RateLimiter::Refill(Bucket &bucket, Clock::time_point now) const
+{
+    const double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+    bucket.refilled = now;
+    if (limits.requests_per_minute > 0)
+        bucket.requests = std::min(Capacity(limits.requests_per_minute), bucket.requests + elapsed * limits.requests_per_minute / 60.0);
+    if (limits.tokens_per_minute > 0)
+        bucket.tokens = std::min(Capacity(limits.tokens_per_minute), bucket.tokens + elapsed * limits.tokens_per_minute / 60.0);
+}
+
+RateLimiter::Clock::duration RateLimiter::TimeUntilReady(const Bucket &bucket, double tokens, Clock::time_point now) const
+{
+    Clock::duration wait = bucket.blocked_until - now;
+    if (limits.requests_per_minute > 0 && bucket.requests < 1)
+        wait = std::max(wait, SecondsToDuration((1 - bucket.requests) * 60.0 / limits.requests_per_minute));
+    if (limits.tokens_per_minute > 0 && bucket.tokens < tokens)
+        wait = std::max(wait, SecondsToDuration((tokens - bucket.tokens) * 60.0 / limits.tokens_per_minute));
+    return wait;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <Backend.hpp>
+
+// Client-side token buckets, one pair per API key: one counts requests, the
+// other estimated model tokens, both refilled continuously at the configured
+// per-minute quota. Callers that find the bucket empty wait in Acquire, and
+// bulk callers additionally wait while any interactive caller is queued on
+// the same key. A limit of 0 disables that bucket.
+class RateLimiter
+{
+public:
+    struct Limits
+    {
+        double requests_per_minute = 0;
+        double tokens_per_minute = 0;
+    };
+
+    struct Stats
+    {
+        uint64_t interactive_waiting = 0;
+        uint64_t bulk_waiting = 0;
+        uint64_t throttled = 0; // Acquire calls that had to wait.
+    };
+
+    void setLimits(const Limits &limits);
+    // Blocks until the key has budget for one request of `tokens`. Returns
+    // false if `cancelled` reports true while waiting.
+    bool Acquire(const std::string &key, size_t tokens, RequestClass request_class, const std::function<bool()> &cancelled);
+    // Takes budget for one request of `tokens` only if the key has it now;
+    // never waits.
+    bool TryAcquire(const std::string &key, size_t tokens, RequestClass request_class);
+    // Called when the server answered 429: empties the request bucket and
+    // holds the key for `delay`.
+    void Backoff(const std::string &key, std::chrono::milliseconds delay);
+    Stats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Bucket
+    {
+        double requests = 0;
+        double tokens = 0;
+        Clock::time_point refilled;
+        Clock::time_point blocked_until;
+        size_t waiting[2] = {0, 0};
+    };
+
+    Bucket &BucketFor(const std::string &key, Clock::time_point now);
+    void Refill(Bucket &bucket, Clock::time_point now) const;
+    Clock::duration TimeUntilReady(const Bucket &bucket, double tokens, Clock::time_point now) const;
+    // Refills the bucket and takes budget if it is this class's turn and the
+    // bucket has it; otherwise sets `wait` to when to look again.
+    bool TryTake(Bucket &bucket, size_t tokens, RequestClass request_class, Clock::duration &wait);
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::unordered_map<std::string, Bucket> buckets;
+    Limits limits;
+    uint64_t throttled = 0;
+};
@@ -0,0 +1,111 @@
+#include <ResponseParser.hpp>
+#include <json.hpp>
+#include <vector>
+using json = nlohmann::json;
+
+namespace
+{
+    // Path to the generated text. An empty key means "array element 0".
+    const char *const kTextPath[] = {"candidates", "", "content", "parts", "", "text"};
+    const size_t kTextPathDepth = sizeof(kTextPath) / sizeof(kTextPath[0]);
+
+    class CandidateTextSax : public nlohmann::json_sax<json>
+    {
+    public:
+        explicit CandidateTextSax(std::string &text) : text(text) {}
+
+        bool found = false;
+
+        bool null() override { return Value(); }
+        bool boolean(bool) override { return Value(); }
+        bool number_integer(number_integer_t) override { return Value(); }
+        bool number_unsigned(number_unsigned_t) override { return Value(); }
+        bool number_float(number_float_t, const string_t &) override { return Value(); }
+        bool binary(binary_t &) override { return Value(); }
+
+        bool string(string_t &val) override
+        {
+            if (matched == frames.size() && frames.size() == kTextPathDepth)
+            {
+                text = std::move(val);
+                found = true;
+                return false; // Nothing after the text is needed.
+            }
+            return Value();
+        }
+
+        bool start_object(std::size_t) override { return Open(false); }
+        bool start_array(std::size_t) override { return Open(true); }
+        bool end_object() override { return Close(); }
+        bool end_array() override { return Close(); }
+
+        bool key(string_t &val) override
+        {
+            Frame &top = frames.back();
+            const size_t depth = frames.size() - 1;
+            top.on_path = depth < kTextPathDepth && val == kTextPath[depth];
+            Update();
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) override
+        {
+            return false;
+        }
+
+    private:
+        struct Frame
+        {
+            bool is_array;
+            size_t index;
+            bool on_path;
+        };
+
+        bool Open(bool is_array)
+        {
+            const size_t depth = frames.size();
+            frames.push_back(Frame{is_array, 0, is_array && depth < kTextPathDepth && kTextPath[depth][0] == '\0'});
+            Update();
+            return true;
+        }
+
+        bool Close()
+        {
+            frames.pop_back();
+            if (matched > frames.size())
+                matched = frames.size();
+            return Value();
+        }
+
+        // Called after every complete value; advances the array index.
+        bool Value()
+        {
+            if (!frames.empty() && frames.back().is_array)
+            {
+                Frame &top = frames.back();
+                ++top.index;
+                top.on_path = false;
+                Update();
+            }
+            return true;
+        }
+
+        void Update()
+        {
+            const size_t top = frames.size() - 1;
+            if (matched >= top)
+                matched = frames[top].on_path ? top + 1 : top;
+        }
+
+        std::string &text;
+        std::vector<Frame> frames;
+        size_t matched = 0; // Leading frames that lie on kTextPath.
+    };
+}
+
+bool ExtractCandidateText(std::string_view body, std::string &text)
+{
+    CandidateTextSax sax(text);
+    json::sax_parse(body.begin(), body.end(), &sax);
+    return sax.found;
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// Pulls candidates[0].content.parts[0].text out of a generateContent
+// response with a SAX pass, without building a DOM. Parsing stops as soon
+// as the text has been read. Returns false if the field is missing.
+bool ExtractCandidateText(std::string_view body, std::string &text);
@@ -1,128 +1,1206 @@
-#include <iostream>
-#include <string>
-#include <curl/curl.h>
-#include <sstream>
-#include <iomanip>
-#include <json.hpp>
-#include <fstream>
+#include <Rest.hpp>
+#include <StreamParser.hpp>
+#include <TextNormalize.hpp>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
 using json = nlohmann::json;
 
-class Translator
+namespace
+{
+    const size_t kMaxIdleHandles = 64;
+    const size_t kWorkerCount = 4;
+    const size_t kResponseBufferBytes = 16 * 1024;
+    const size_t kDefaultMemoryCacheBytes = 4 * 1024 * 1024;
+    // Small enough that a paragraph spreads over all workers, large enough
+    // that each request carries a few sentences of context.
+    const size_t kDocumentChunkChars = 400;
+    const char *const kDefaultModel = "gemini-2.0-flash";
+    const std::chrono::milliseconds kBackoffBase(500);
+    const std::chrono::milliseconds kBackoffCap(8000);
+    // Hedging only starts once the p95 estimate rests on enough samples.
+    const size_t kHedgeMinSamples = 20;
+    // Rough token estimate for the rate limiter: Gemini averages about four
+    // bytes of English per token, and an answer is a few hundred tokens.
+    const size_t kBytesPerToken = 4;
+    const size_t kEstimatedOutputTokens = 300;
+    // How long a key is passed over after it ran out of quota (when the
+    // server gave no Retry-After) or was rejected.
+    const std::chrono::milliseconds kQuotaCooldown(10000);
+    const std::chrono::milliseconds kAuthCooldown(600000);
+    // Bump whenever the prompt changes so stale cached answers are ignored.
+    const char *const kPromptVersion = "2";
+
+    void GlobalInitOnce()
+    {
+        static std::once_flag flag;
+        std::call_once(flag, []
+                       { curl_global_init(CURL_GLOBAL_DEFAULT); });
+    }
+
+    bool IsRetryable(CURLcode res)
+    {
+        switch (res)
+        {
+        case CURLE_COULDNT_RESOLVE_PROXY:
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SSL_CONNECT_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool IsRetryableStatus(long status)
+    {
+        return status == 429 || status >= 500;
+    }
+
+    bool IsAuthStatus(long status)
+    {
+        return status == 401 || status == 403;
+    }
+
+    // Full-jitter exponential backoff, stretched to honour Retry-After.
+    std::chrono::milliseconds BackoffDelay(int attempt, std::chrono::milliseconds retry_after)
+    {
+        thread_local std::mt19937 rng{std::random_device{}()};
+        const long long ceiling = std::min<long long>(kBackoffCap.count(), kBackoffBase.count() << std::min(attempt, 10));
+        std::uniform_int_distribution<long long> jitter(0, ceiling);
+        return std::max(retry_after, std::chrono::milliseconds(jitter(rng)));
+    }
+
+    void SleepUnlessCancelled(std::chrono::milliseconds delay, const TranslationRequest *request)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + delay;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (request && request->IsCancelled())
+                throw TranslationCancelled();
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                std::chrono::milliseconds(50), deadline - std::chrono::steady_clock::now()));
+        }
+    }
+
+    void Log(const TranslatorConfig &config, const std::string &message)
+    {
+        if (config.log)
+            config.log(message);
+    }
+
+    std::string CacheKey(const TranslationBackend &backend, PromptProfile profile, const std::string &word)
+    {
+        return backend.Name() + '\n' + kPromptVersion + '\n' + PromptProfileName(profile) + '\n' + NormalizeKey(word);
+    }
+}
+
+class Translator::HandleLease
 {
 public:
-    std::string Translate(std::string word);
-    void setApiKey(std::string apiKey);
-    std::string getApiKey() const;
-    void setProxy(std::string ip, std::string port);
+    explicit HandleLease(Translator &owner) : owner(owner), curl(owner.AcquireHandle()) {}
+    ~HandleLease()
+    {
+        if (curl)
+            owner.ReleaseHandle(curl);
+    }
+    HandleLease(const HandleLease &) = delete;
+    HandleLease &operator=(const HandleLease &) = delete;
+
+    CURL *get() const { return curl; }
 
 private:
-    std::string api_key;
-    std::string proxy;
+    Translator &owner;
+    CURL *curl;
 };
 
+// What a transfer needs kept alive until it completes.
+struct Translator::Transfer
+{
+    Transfer(Translator &owner, KeyPool::Lease key) : key(std::move(key)), handle(owner) {}
+
+    KeyPool::Lease key;
+    HandleLease handle;
+    std::string url;
+    std::string body;
+    std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> headers{nullptr, &curl_slist_free_all};
+};
+
+Translator::Translator()
+    : memory_cache(kDefaultMemoryCacheBytes)
+{
+    GlobalInitOnce();
+    transport = std::make_unique<MultiTransport>();
+    auto initial = std::make_shared<TranslatorConfig>();
+    initial->backends[static_cast<int>(RequestClass::Interactive)] = std::make_shared<GeminiBackend>(kDefaultModel);
+    initial->backends[static_cast<int>(RequestClass::Bulk)] = initial->backends[static_cast<int>(RequestClass::Interactive)];
+    current_config = std::move(initial);
+    share = curl_share_init();
+    if (share)
+    {
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, &Translator::LockShare);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, &Translator::UnlockShare);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+}
+
+Translator::~Translator()
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+        jobs.clear();
+        interactive_jobs = 0;
+    }
+    queue_cv.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+
+    // Abandoned hedge attempts still hold pooled handles; draining the
+    // transport returns them before the pool is freed.
+    transport.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        for (CURL *curl : idle_handles)
+            curl_easy_cleanup(curl);
+        idle_handles.clear();
+    }
+    if (share)
+        curl_share_cleanup(share);
+}
+
+void Translator::LockShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+    (void)handle;
+    (void)access;
+    static_cast<Translator *>(userptr)->share_locks[data].lock();
+}
+
+void Translator::UnlockShare(CURL *handle, curl_lock_data data, void *userptr)
+{
+    (void)handle;
+    static_cast<Translator *>(userptr)->share_locks[data].unlock();
+}
+
+CURL *Translator::AcquireHandle()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!idle_handles.empty())
+        {
+            CURL *curl = idle_handles.back();
+            idle_handles.pop_back();
+            return curl;
+        }
+    }
+    return curl_easy_init();
+}
+
+void Translator::ReleaseHandle(CURL *curl)
+{
+    // Connections stay in the transport's cache; pooling only saves
+    // allocating and initializing a new handle per lookup.
+    curl_easy_reset(curl);
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (idle_handles.size() < kMaxIdleHandles)
+        idle_handles.push_back(curl);
+    else
+        curl_easy_cleanup(curl);
+}
+
+ConfigSnapshot Translator::GetConfig() const
+{
+    return std::atomic_load(&current_config);
+}
+
+void Translator::UpdateConfig(const std::function<void(TranslatorConfig &config)> &modify)
+{
+    std::lock_guard<std::mutex> lock(config_write_mutex);
+    auto updated = std::make_shared<TranslatorConfig>(*std::atomic_load(&current_config));
+    modify(*updated);
+    std::atomic_store(&current_config, ConfigSnapshot(std::move(updated)));
+}
+
 void Translator::setProxy(std::string ip, std::string port)
 {
-    proxy = "http://" + ip + ":" + port;
+    std::string proxy = "http://" + ip + ":" + port;
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.proxy = std::move(proxy); });
 }
 
 void Translator::setApiKey(std::string apiKey)
 {
-    this->api_key = apiKey;
+    keys.setKeys({std::move(apiKey)});
 }
 
 std::string Translator::getApiKey() const
 {
-    return api_key;
+    std::vector<std::string> api_keys = keys.Keys();
+    return api_keys.empty() ? std::string() : api_keys.front();
+}
+
+void Translator::setApiKeys(std::vector<std::string> api_keys)
+{
+    keys.setKeys(std::move(api_keys));
+}
+
+std::vector<std::string> Translator::getApiKeys() const
+{
+    return keys.Keys();
+}
+
+void Translator::setConnectTimeout(std::chrono::milliseconds connect_timeout)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.connect_timeout = connect_timeout; });
+}
+
+void Translator::setTotalTimeout(std::chrono::milliseconds total_timeout)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.total_timeout = total_timeout; });
+}
+
+void Translator::setMaxAttempts(int max_attempts)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.max_attempts = std::max(1, max_attempts); });
+}
+
+void Translator::setHedging(bool enabled)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.hedging = enabled; });
 }
 
-size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
+void Translator::setLogCallback(LogCallback log)
 {
-    ((std::string *)userp)->append((char *)contents, size * nmemb);
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.log = std::move(log); });
+}
+
+void LatencyTracker::Record(std::chrono::milliseconds latency)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    samples[next] = latency;
+    next = (next + 1) % kWindow;
+    count = std::min(count + 1, kWindow);
+}
+
+size_t LatencyTracker::Count() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+std::chrono::milliseconds LatencyTracker::Percentile(double p) const
+{
+    std::chrono::milliseconds sorted[kWindow];
+    size_t n;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        n = count;
+        std::copy(samples, samples + n, sorted);
+    }
+    if (n == 0)
+        return std::chrono::milliseconds(0);
+    const size_t rank = std::min(n - 1, static_cast<size_t>(p * n));
+    std::nth_element(sorted, sorted + rank, sorted + n);
+    return sorted[rank];
+}
+
+void Translator::setBackend(std::shared_ptr<TranslationBackend> backend)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 {
+        config.backends[static_cast<int>(RequestClass::Interactive)] = backend;
+        config.backends[static_cast<int>(RequestClass::Bulk)] = backend; });
+}
+
+void Translator::setBackend(std::shared_ptr<TranslationBackend> backend, RequestClass request_class)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.backends[static_cast<int>(request_class)] = std::move(backend); });
+}
+
+void Translator::setPromptProfile(PromptProfile profile)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 {
+        config.profiles[static_cast<int>(RequestClass::Interactive)] = profile;
+        config.profiles[static_cast<int>(RequestClass::Bulk)] = profile; });
+}
+
+void Translator::setPromptProfile(PromptProfile profile, RequestClass request_class)
+{
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.profiles[static_cast<int>(request_class)] = profile; });
+}
+
+void Translator::EnableDiskCache(const std::string &path, uint64_t max_bytes)
+{
+    // Opening the cache reads the whole index; do it before taking the
+    // writer lock.
+    auto cache = std::make_shared<DiskCache>(path, max_bytes);
+    UpdateConfig([&](TranslatorConfig &config)
+                 { config.disk_cache = std::move(cache); });
+}
+
+DiskCache::Stats Translator::GetDiskCacheStats() const
+{
+    const std::shared_ptr<DiskCache> cache = GetConfig()->disk_cache;
+    return cache ? cache->GetStats() : DiskCache::Stats();
+}
+
+void Translator::ForEachCached(const std::function<void(const std::string &word, const TranslationResult &result)> &visit) const
+{
+    const ConfigSnapshot config = GetConfig();
+    const std::shared_ptr<DiskCache> cache = config->disk_cache;
+    if (!cache)
+        return;
+    // Keys are backend, prompt version, profile and word, one per line.
+    const std::string prefix = config->Backend(RequestClass::Interactive).Name() + '\n' + kPromptVersion + '\n';
+    cache->ForEach([&](const std::string &key, const std::string &value)
+                   {
+        const size_t word_start = key.rfind('\n');
+        if (word_start == std::string::npos || key.compare(0, prefix.size(), prefix) != 0)
+            return;
+        try
+        {
+            visit(key.substr(word_start + 1), TranslationResult::Parse(value));
+        }
+        catch (const std::exception &)
+        {
+            // Not a result this version can read; skip it.
+        } });
+}
+
+void Translator::setMemoryCacheLimit(size_t max_bytes)
+{
+    memory_cache.setMaxBytes(max_bytes);
+}
+
+LruCache::Stats Translator::GetMemoryCacheStats() const
+{
+    return memory_cache.GetStats();
+}
+
+void Translator::setRateLimits(double requests_per_minute, double tokens_per_minute)
+{
+    RateLimiter::Limits limits;
+    limits.requests_per_minute = requests_per_minute;
+    limits.tokens_per_minute = tokens_per_minute;
+    rate_limiter.setLimits(limits);
+}
+
+RateLimiter::Stats Translator::GetSchedulerStats() const
+{
+    return rate_limiter.GetStats();
+}
+
+const Metrics &Translator::GetMetrics() const
+{
+    return metrics;
+}
+
+void Translator::StartWorkers()
+{
+    if (!workers.empty())
+        return;
+    for (size_t i = 0; i < kWorkerCount; ++i)
+        workers.emplace_back(&Translator::WorkerLoop, this);
+}
+
+void Translator::WorkerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this]
+                          { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            if (interactive_jobs > 0)
+                --interactive_jobs;
+        }
+        job();
+    }
+}
+
+void Translator::Enqueue(std::function<void()> job, RequestClass request_class)
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        StartWorkers();
+        // Interactive jobs overtake queued bulk jobs but stay FIFO among
+        // themselves.
+        if (request_class == RequestClass::Interactive)
+            jobs.insert(jobs.begin() + interactive_jobs++, std::move(job));
+        else
+            jobs.push_back(std::move(job));
+    }
+    queue_cv.notify_one();
+}
+
+std::shared_ptr<TranslationRequest> Translator::TranslateAsync(std::string word, TranslateCallback done, RequestClass request_class)
+{
+    auto request = std::make_shared<TranslationRequest>();
+    Enqueue([this, request, word = std::move(word), done = std::move(done), request_class]
+            {
+        if (request->IsCancelled())
+            return;
+        TranslationResult result;
+        std::string error;
+        try
+        {
+            const ConfigSnapshot config = GetConfig();
+            result = DoTranslate(config, word, request_class, config->Profile(request_class), request.get());
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+        if (!request->IsCancelled() && done)
+            done(result, error); }, request_class);
+    return request;
+}
+
+std::shared_ptr<TranslationRequest> Translator::TranslateStreamAsync(std::string word, PartialCallback partial, TranslateCallback done)
+{
+    auto request = std::make_shared<TranslationRequest>();
+    Enqueue([this, request, word = std::move(word), partial = std::move(partial), done = std::move(done)]
+            {
+        if (request->IsCancelled())
+            return;
+        TranslationResult result;
+        std::string error;
+        try
+        {
+            const ConfigSnapshot config = GetConfig();
+            const PromptProfile profile = config->Profile(RequestClass::Interactive);
+            const std::string cache_key = CacheKey(config->Backend(RequestClass::Interactive), profile, word);
+            if (!LookupCached(*config, cache_key, result))
+            {
+                // Shares the flight with any lookup of the same key. Only the
+                // leader streams; a lookup that joins late gets no partial
+                // text, just the final result.
+                result = SingleFlight(cache_key, request.get(), [&]
+                                      {
+                    TranslationResult fetched;
+                    if (LookupCached(*config, cache_key, fetched, false))
+                        return fetched;
+                    PartialCallback forward = [&request, &partial](const std::string &text)
+                    {
+                        if (!request->IsCancelled() && partial)
+                            partial(text);
+                    };
+                    const Prompt prompt = BuildPrompt(profile, word);
+                    fetched = ParseResult(WithRetries(*config, request.get(), [&]
+                                                      { return GenerateStream(*config, prompt, RequestClass::Interactive, request.get(), forward); }));
+                    CompleteResult(profile, word, fetched);
+                    StoreCached(*config, cache_key, fetched);
+                    return fetched; });
+            }
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+        if (!request->IsCancelled() && done)
+            done(result, error); }, RequestClass::Interactive);
+    return request;
+}
+
+std::shared_ptr<TranslationRequest> Translator::TranslateDocumentAsync(std::string text, PartialCallback partial, TranslateCallback done)
+{
+    struct Document
+    {
+        std::mutex mutex;
+        std::string text;
+        std::vector<TextChunk> chunks;
+        std::vector<std::optional<std::string>> translated;
+        size_t next_emit = 0;
+        size_t remaining = 0;
+        std::string assembled;
+        std::string error;
+    };
+    auto request = std::make_shared<TranslationRequest>();
+    // All parts use the settings the document started with.
+    const ConfigSnapshot config = GetConfig();
+    auto document = std::make_shared<Document>();
+    document->chunks = SplitIntoChunks(text, kDocumentChunkChars);
+    document->text = std::move(text);
+    document->translated.resize(document->chunks.size());
+    document->remaining = document->chunks.size();
+    if (document->chunks.empty())
+    {
+        Enqueue([request, done = std::move(done)]
+                {
+            if (!request->IsCancelled() && done)
+                done(TranslationResult(), "Nothing to translate"); }, RequestClass::Interactive);
+        return request;
+    }
+
+    for (size_t i = 0; i < document->chunks.size(); ++i)
+    {
+        Enqueue([this, config, request, document, i, partial, done]
+                {
+            std::string persian;
+            std::string error;
+            const std::string &chunk = document->chunks[i].text;
+            try
+            {
+                if (request->IsCancelled())
+                    throw TranslationCancelled();
+                persian = DoTranslate(config, chunk, RequestClass::Interactive, PromptProfile::Sentence, request.get()).persian_definition;
+                if (persian.empty())
+                    throw std::runtime_error("Empty translation for part " + std::to_string(i + 1));
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+                persian = chunk;
+            }
+
+            // Callbacks run under the lock so partial results arrive in order.
+            std::lock_guard<std::mutex> lock(document->mutex);
+            document->translated[i] = std::move(persian);
+            if (!error.empty() && document->error.empty())
+                document->error = error;
+            bool grew = false;
+            while (document->next_emit < document->chunks.size() && document->translated[document->next_emit])
+            {
+                document->assembled += *document->translated[document->next_emit];
+                document->assembled += document->chunks[document->next_emit].separator;
+                ++document->next_emit;
+                grew = true;
+            }
+            if (--document->remaining > 0)
+            {
+                if (grew && !request->IsCancelled() && partial)
+                    partial(document->assembled);
+                return;
+            }
+            if (!request->IsCancelled() && done)
+            {
+                TranslationResult result;
+                result.type = "document";
+                result.word = document->text;
+                result.persian_definition = document->assembled;
+                done(result, document->error);
+            } }, RequestClass::Interactive);
+    }
+    return request;
+}
+
+int Translator::OnTransferProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+{
+    (void)dltotal;
+    (void)dlnow;
+    (void)ultotal;
+    (void)ulnow;
+    const TranslationRequest *request = static_cast<const TranslationRequest *>(clientp);
+    return request->IsCancelled() ? 1 : 0;
+}
+
+size_t WriteCallback(char *contents, size_t size, size_t nmemb, void *userp)
+{
+    ((std::string *)userp)->append(contents, size * nmemb);
     return size * nmemb;
 }
 
-std::string Translator::Translate(std::string word)
-{
-    CURL *curl = curl_easy_init();
-    if (curl)
-    {
-        std::string api_key = this->api_key;
-        std::string url = "https://generativelanguage.googleapis.com/v1beta/models/gemini-2.0-flash:generateContent?key=" + api_key;
-        std::string text = word;
-        std::string prompt =
-            "Provide Translation the word or sentence(Check which one is it word or sentence) '" + text + "' in the following JSON format:\n"
-                                                                                                          "{\n"
-                                                                                                          "  \"type\": \"word\",\n"
-                                                                                                          "  \"word\": \"" +
-            text + "\",\n"
-                   "  \"definition\": \"[clear definition]\",\n"
-                   "  \"examples\": [\"[example 1]\", \"[example 2]\"],\n"
-                   "  \"pronunciation\": \"[IPA pronunciation if available]\",\n"
-                   "  \"persian_definition\": \"[Persian translation]\",\n"
-                   "  \"synonyms\": [\"[synonym 1]\", \"[synonym 2]\"],\n"
-                   "  \"acronym\": \"[full form if acronym, otherwise empty]\"\n"
-                   "}\n"
-                   "Return only valid JSON.";
-
-        json payload = {
-            {"contents", {{{"parts", {{{"text", prompt}}}}}}}};
-
-        std::string json_data = payload.dump();
-
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
-        struct curl_slist *headers = nullptr;
-        headers = curl_slist_append(headers, "Content-Type: application/json");
-
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-        curl_easy_setopt(curl, CURLOPT_PROXY, proxy.c_str());
-        std::string response_string;
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string);
-
-        CURLcode res = curl_easy_perform(curl);
-        if (res != CURLE_OK)
-            std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
+TranslationResult Translator::Translate(std::string word, RequestClass request_class)
+{
+    const ConfigSnapshot config = GetConfig();
+    return DoTranslate(config, word, request_class, config->Profile(request_class), nullptr);
+}
+
+bool Translator::LookupCached(const TranslatorConfig &config, const std::string &cache_key, TranslationResult &value, bool count)
+{
+    if (memory_cache.Lookup(cache_key, value))
+    {
+        if (count)
+            ++metrics.memory_cache_hits;
+        return true;
+    }
+    std::string serialized;
+    if (config.disk_cache && config.disk_cache->Lookup(cache_key, serialized))
+    {
+        json j = json::parse(serialized, nullptr, false);
+        if (!j.is_discarded())
+        {
+            value = TranslationResult::FromJson(j);
+            memory_cache.Store(cache_key, value);
+            if (count)
+                ++metrics.disk_cache_hits;
+            return true;
+        }
+    }
+    if (count)
+        ++metrics.cache_misses;
+    return false;
+}
+
+void Translator::StoreCached(const TranslatorConfig &config, const std::string &cache_key, const TranslationResult &value)
+{
+    memory_cache.Store(cache_key, value);
+    if (config.disk_cache)
+        config.disk_cache->Store(cache_key, value.Serialize());
+}
+
+TranslationResult Translator::ParseResult(const std::string &text)
+{
+    const auto started = std::chrono::steady_clock::now();
+    TranslationResult result = TranslationResult::Parse(text);
+    metrics.result_parse.Record(std::chrono::steady_clock::now() - started);
+    return result;
+}
+
+void Translator::RecordTransfer(CURL *curl)
+{
+    // curl reports each phase as the time from the start of the transfer
+    // until that phase ended, in microseconds.
+    curl_off_t name_lookup = 0, connected = 0, app_connected = 0, pre_transfer = 0, start_transfer = 0, total = 0;
+    curl_off_t uploaded = 0, downloaded = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &name_lookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connected);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &app_connected);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &pre_transfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &start_transfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+
+    ++metrics.requests;
+    // A reused connection reports zero for the handshake phases; recording
+    // those would hide what new connections cost.
+    if (connects > 0 && connected > 0)
+    {
+        metrics.new_connections += static_cast<uint64_t>(connects);
+        metrics.dns.Record(static_cast<uint64_t>(name_lookup));
+        metrics.connect.Record(static_cast<uint64_t>(std::max<curl_off_t>(0, connected - name_lookup)));
+        if (app_connected > 0)
+            metrics.tls.Record(static_cast<uint64_t>(std::max<curl_off_t>(0, app_connected - connected)));
+    }
+    if (start_transfer > 0)
+        metrics.server.Record(static_cast<uint64_t>(std::max<curl_off_t>(0, start_transfer - pre_transfer)));
+    metrics.total.Record(static_cast<uint64_t>(total));
+    metrics.bytes_sent += static_cast<uint64_t>(uploaded);
+    metrics.bytes_received += static_cast<uint64_t>(downloaded);
+}
+
+TranslationResult Translator::DoTranslate(const ConfigSnapshot &config, const std::string &word, RequestClass request_class, PromptProfile profile, const TranslationRequest *request)
+{
+    const std::string cache_key = CacheKey(config->Backend(request_class), profile, word);
+    TranslationResult result;
+    if (LookupCached(*config, cache_key, result))
+        return result;
+
+    return SingleFlight(cache_key, request, [&]
+                        {
+        TranslationResult fetched;
+        // Another flight may have finished between the miss above and now.
+        if (LookupCached(*config, cache_key, fetched, false))
+            return fetched;
+        fetched = ParseResult(Generate(*config, BuildPrompt(profile, word), request_class, request));
+        CompleteResult(profile, word, fetched);
+        StoreCached(*config, cache_key, fetched);
+        return fetched; });
+}
+
+TranslationResult Translator::SingleFlight(const std::string &cache_key, const TranslationRequest *request, const std::function<TranslationResult()> &fetch)
+{
+    FlightShard &shard = flight_shards[std::hash<std::string>()(cache_key) % kFlightShards];
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        std::promise<TranslationResult> promise;
+        std::shared_future<TranslationResult> flight;
+        bool leader = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.flights.find(cache_key);
+            if (it != shard.flights.end())
+            {
+                flight = it->second;
+            }
+            else
+            {
+                flight = promise.get_future().share();
+                shard.flights.emplace(cache_key, flight);
+                leader = true;
+            }
+        }
+
+        if (leader)
+        {
+            try
+            {
+                promise.set_value(fetch());
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.flights.erase(cache_key);
+            }
+            return flight.get();
+        }
+
+        // Followers wait for the leader but still honour their own cancellation.
+        while (flight.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready)
+        {
+            if (request && request->IsCancelled())
+                throw TranslationCancelled();
+        }
+        try
+        {
+            return flight.get();
+        }
+        catch (const TranslationCancelled &)
+        {
+            // The leader was cancelled, not this lookup; retry once, most
+            // likely as the new leader.
+            if (attempt > 0 || (request && request->IsCancelled()))
+                throw;
+        }
+    }
+    throw std::runtime_error("Translation failed");
+}
+
+std::vector<std::optional<TranslationResult>> Translator::TranslateBatch(const std::vector<std::string> &words)
+{
+    const ConfigSnapshot config = GetConfig();
+    const TranslationBackend &backend = config->Backend(RequestClass::Bulk);
+    const PromptProfile profile = config->Profile(RequestClass::Bulk);
+    std::vector<std::optional<TranslationResult>> results(words.size());
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        TranslationResult cached;
+        if (LookupCached(*config, CacheKey(backend, profile, words[i]), cached))
+            results[i] = std::move(cached);
         else
+            pending.push_back(i);
+    }
+
+    size_t next = 0;
+    while (next < pending.size())
+    {
+        std::vector<size_t> batch;
+        std::vector<std::string> texts;
+        size_t chars = 0;
+        while (next < pending.size() && batch.size() < kBatchMaxItems)
+        {
+            const std::string &word = words[pending[next]];
+            if (!batch.empty() && chars + word.size() > kBatchMaxInputChars)
+                break;
+            chars += word.size();
+            batch.push_back(pending[next]);
+            texts.push_back(word);
+            ++next;
+        }
+
+        bool batched = false;
+        if (batch.size() > 1)
         {
-            json j = json::parse(response_string);
-            std::string text_str;
             try
             {
-                if (j.contains("candidates") && !j["candidates"].empty())
+                const std::string text = Generate(*config, BuildBatchPrompt(profile, texts), RequestClass::Bulk, nullptr);
+                const auto parse_started = std::chrono::steady_clock::now();
+                json items = json::parse(text);
+                metrics.result_parse.Record(std::chrono::steady_clock::now() - parse_started);
+                if (items.is_array() && items.size() == batch.size() &&
+                    std::all_of(items.begin(), items.end(), [](const json &item)
+                                { return item.is_object(); }))
                 {
-                    auto &parts = j["candidates"][0]["content"]["parts"];
-                    if (!parts.empty() && parts[0].contains("text"))
+                    for (size_t i = 0; i < batch.size(); ++i)
                     {
-                        text_str = parts[0]["text"].get<std::string>();
-                        std::cout << "Extracted text:\n"
-                                  << text_str << std::endl;
-                        const std::string code_block_start = "```json\n";
-                        const std::string code_block_end = "\n```";
-                        if (text_str.rfind(code_block_start, 0) == 0)
-                        {
-                            text_str = text_str.substr(code_block_start.length());
-                            size_t end_pos = text_str.rfind(code_block_end);
-                            if (end_pos != std::string::npos)
-                            {
-                                text_str = text_str.substr(0, end_pos);
-                            }
-                        }
+                        TranslationResult item = TranslationResult::FromJson(items[i]);
+                        CompleteResult(profile, texts[i], item);
+                        StoreCached(*config, CacheKey(backend, profile, texts[i]), item);
+                        results[batch[i]] = std::move(item);
                     }
+                    batched = true;
+                }
+                else
+                {
+                    Log(*config, "Batch response did not contain " + std::to_string(batch.size()) + " results, falling back to single lookups.");
                 }
-                return text_str;
             }
             catch (const std::exception &e)
             {
-                std::cerr << "Error extracting text: " << e.what() << std::endl;
+                Log(*config, std::string("Batch translation failed, falling back to single lookups: ") + e.what());
             }
         }
 
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+        if (!batched)
+        {
+            for (size_t index : batch)
+            {
+                try
+                {
+                    results[index] = DoTranslate(config, words[index], RequestClass::Bulk, profile, nullptr);
+                }
+                catch (const std::exception &e)
+                {
+                    Log(*config, "Translation failed for '" + words[index] + "': " + e.what());
+                }
+            }
+        }
+    }
+    return results;
+}
+
+std::unique_ptr<Translator::Transfer> Translator::PrepareTransfer(const TranslatorConfig &config, bool stream, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request, curl_write_callback write, void *sink)
+{
+    const TranslationBackend &backend = config.Backend(request_class);
+    // Prefer a key with quota to spare, so one key's empty bucket does not
+    // hold up a lookup another key could serve right away.
+    const size_t estimated_tokens = prompt.text.size() / kBytesPerToken + kEstimatedOutputTokens;
+    bool reserved = false;
+    KeyPool::Lease key = keys.Acquire([&](const std::string &candidate)
+                                      { return reserved = rate_limiter.TryAcquire(candidate, estimated_tokens, request_class); });
+    const std::string api_key = key.Key();
+    // Otherwise wait for quota before taking a handle, so throttled lookups
+    // don't pin pooled connections.
+    if (!reserved && !rate_limiter.Acquire(api_key, estimated_tokens, request_class, [request]
+                                           { return request && request->IsCancelled(); }))
+        throw TranslationCancelled();
+
+    auto transfer = std::make_unique<Transfer>(*this, std::move(key));
+    CURL *curl = transfer->handle.get();
+    if (!curl)
+        throw std::runtime_error("curl_easy_init() failed");
+
+    transfer->url = backend.BuildUrl(api_key, stream);
+    transfer->body = backend.BuildBody(prompt.text, prompt.response_schema);
+    transfer->headers.reset(curl_slist_append(nullptr, "Content-Type: application/json"));
+
+    if (share)
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    // HTTP/2 over TLS, and wait for an existing connection to confirm it can
+    // multiplex rather than opening another one.
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_URL, transfer->url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers.get());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer->body.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->body.size()));
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_PROXY, config.proxy.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOPROXY, "localhost,127.0.0.1");
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(config.connect_timeout.count()));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(config.total_timeout.count()));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, sink);
+    if (request)
+    {
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, &Translator::OnTransferProgress);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, request);
+    }
+    return transfer;
+}
+
+long Translator::FinishTransfer(Transfer &transfer, CURLcode res, std::chrono::milliseconds &retry_after)
+{
+    CURL *curl = transfer.handle.get();
+    if (res == CURLE_ABORTED_BY_CALLBACK)
+        throw TranslationCancelled();
+    RecordTransfer(curl);
+    if (res != CURLE_OK)
+    {
+        ++metrics.transport_errors;
+        const std::string message = std::string("Request failed: ") + curl_easy_strerror(res);
+        if (IsRetryable(res))
+            throw RetryableError(message, std::chrono::milliseconds(0));
+        throw std::runtime_error(message);
+    }
+
+    const std::string &api_key = transfer.key.Key();
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_off_t retry_after_seconds = 0;
+    curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retry_after_seconds);
+    retry_after = std::chrono::seconds(retry_after_seconds);
+    if (status >= 400)
+        ++metrics.http_errors;
+    if (status == 429)
+    {
+        rate_limiter.Backoff(api_key, retry_after);
+        keys.Cooldown(api_key, std::max(retry_after, kQuotaCooldown));
+    }
+    else if (IsAuthStatus(status))
+    {
+        keys.Cooldown(api_key, kAuthCooldown);
+    }
+    return status;
+}
+
+long Translator::Post(const TranslatorConfig &config, bool stream, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request, curl_write_callback write, void *sink, std::chrono::milliseconds &retry_after)
+{
+    std::unique_ptr<Transfer> transfer = PrepareTransfer(config, stream, prompt, request_class, request, write, sink);
+    const CURLcode res = transport->Perform(transfer->handle.get());
+    return FinishTransfer(*transfer, res, retry_after);
+}
+
+// Auth failures are worth retrying only if another key can take over.
+bool Translator::ShouldRetry(long status) const
+{
+    return IsRetryableStatus(status) || (IsAuthStatus(status) && keys.HasUsableKey());
+}
+
+std::string Translator::WithRetries(const TranslatorConfig &config, const TranslationRequest *request, const std::function<std::string()> &attempt)
+{
+    const int max_attempts = config.max_attempts;
+    for (int n = 1;; ++n)
+    {
+        try
+        {
+            return attempt();
+        }
+        catch (const RetryableError &e)
+        {
+            if (n >= max_attempts)
+                throw;
+            const std::chrono::milliseconds delay = BackoffDelay(n - 1, e.retry_after);
+            ++metrics.retries;
+            Log(config, std::string(e.what()) + "; retrying in " + std::to_string(delay.count()) + " ms (attempt " + std::to_string(n + 1) + " of " + std::to_string(max_attempts) + ")");
+            SleepUnlessCancelled(delay, request);
+        }
+    }
+}
+
+std::string Translator::Generate(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request)
+{
+    if (config.hedging && latencies.Count() >= kHedgeMinSamples)
+        return GenerateHedged(config, prompt, request_class, request);
+    return WithRetries(config, request, [&]
+                       { return GenerateOnce(config, prompt, request_class, request); });
+}
+
+std::string Translator::GenerateHedged(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request)
+{
+    // Attempts run on the transport's event loop rather than on threads of
+    // their own. One still running when this call returns is cancelled and
+    // releases its transfer from the completion callback.
+    struct Attempt
+    {
+        explicit Attempt(const TranslationRequest *parent) : token(parent) {}
+        TranslationRequest token;
+        std::string response;
+        std::unique_ptr<Transfer> transfer;
+        std::chrono::steady_clock::time_point started;
+        CURLcode result = CURLE_OK;
+        bool finished = false;
+    };
+    struct HedgeState
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool abandoned = false;
+    };
+    auto state = std::make_shared<HedgeState>();
+    std::vector<std::shared_ptr<Attempt>> running;
+
+    struct Abandon
+    {
+        HedgeState &state;
+        std::vector<std::shared_ptr<Attempt>> &running;
+        ~Abandon()
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.abandoned = true;
+            for (const std::shared_ptr<Attempt> &attempt : running)
+            {
+                attempt->token.Cancel();
+                if (attempt->finished)
+                    attempt->transfer.reset();
+            }
+        }
+    } abandon{*state, running};
+
+    auto start = [&]
+    {
+        auto attempt = std::make_shared<Attempt>(request);
+        attempt->response.reserve(kResponseBufferBytes);
+        attempt->transfer = PrepareTransfer(config, false, prompt, request_class, &attempt->token, WriteCallback, &attempt->response);
+        attempt->started = std::chrono::steady_clock::now();
+        CURL *curl = attempt->transfer->handle.get();
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            running.push_back(attempt);
+        }
+        transport->Start(curl, [state, attempt](CURLcode res)
+                         {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            attempt->result = res;
+            attempt->finished = true;
+            if (state->abandoned)
+                attempt->transfer.reset();
+            state->cv.notify_all(); });
+    };
+    auto any_finished = [&]
+    {
+        return std::any_of(running.begin(), running.end(), [](const std::shared_ptr<Attempt> &attempt)
+                           { return attempt->finished; });
+    };
+
+    // One hedge per lookup, on top of the attempts; retries are counted for
+    // the lookup as a whole, not per attempt, and only start once nothing
+    // is left running.
+    const std::chrono::milliseconds hedge_after = latencies.Percentile(0.95);
+    const int max_attempts = config.max_attempts;
+    int retries = 0;
+    bool hedged = false;
+    start();
+    auto round_started = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    for (;;)
+    {
+        if (!hedged && running.size() == 1 && !running.front()->finished)
+        {
+            if (!state->cv.wait_until(lock, round_started + hedge_after, any_finished))
+            {
+                lock.unlock();
+                Log(config, "No answer after " + std::to_string(hedge_after.count()) + " ms, sending a hedged request.");
+                ++metrics.hedged;
+                hedged = true;
+                start();
+                lock.lock();
+            }
+            continue;
+        }
+        state->cv.wait(lock, any_finished);
+        auto done = std::find_if(running.begin(), running.end(), [](const std::shared_ptr<Attempt> &attempt)
+                                 { return attempt->finished; });
+        std::shared_ptr<Attempt> attempt = *done;
+        running.erase(done);
+        lock.unlock();
+
+        try
+        {
+            std::chrono::milliseconds retry_after(0);
+            const long status = FinishTransfer(*attempt->transfer, attempt->result, retry_after);
+            attempt->transfer.reset();
+            return ReadReply(config, request_class, status, attempt->response, retry_after, attempt->started);
+        }
+        catch (const TranslationCancelled &)
+        {
+            throw;
+        }
+        catch (const RetryableError &e)
+        {
+            attempt->transfer.reset();
+            lock.lock();
+            if (!running.empty())
+                continue;
+            lock.unlock();
+            if (retries + 1 >= max_attempts)
+                throw;
+            const std::chrono::milliseconds delay = BackoffDelay(retries, e.retry_after);
+            ++retries;
+            ++metrics.retries;
+            Log(config, std::string(e.what()) + "; retrying in " + std::to_string(delay.count()) + " ms (attempt " + std::to_string(retries + 1) + " of " + std::to_string(max_attempts) + ")");
+            SleepUnlessCancelled(delay, request);
+            start();
+            round_started = std::chrono::steady_clock::now();
+            lock.lock();
+        }
+        catch (...)
+        {
+            attempt->transfer.reset();
+            lock.lock();
+            if (running.empty())
+                throw;
+        }
     }
-    return 0;
-}
\ No newline at end of file
+}
+
+std::string Translator::ReadReply(const TranslatorConfig &config, RequestClass request_class, long status, const std::string &response, std::chrono::milliseconds retry_after, std::chrono::steady_clock::time_point started)
+{
+    if (ShouldRetry(status))
+        throw RetryableError("HTTP " + std::to_string(status) + ": " + response.substr(0, 200), retry_after);
+    if (status >= 400)
+        throw std::runtime_error("HTTP " + std::to_string(status) + ": " + response.substr(0, 200));
+    latencies.Record(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started));
+
+    std::string text_str;
+    const auto parse_started = std::chrono::steady_clock::now();
+    const bool extracted = config.Backend(request_class).ExtractText(response, text_str);
+    metrics.envelope_parse.Record(std::chrono::steady_clock::now() - parse_started);
+    if (!extracted)
+        throw std::runtime_error("Error extracting text: " + response.substr(0, 200));
+    return text_str;
+}
+
+std::string Translator::GenerateOnce(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request)
+{
+    // Each worker keeps its buffer between calls, so after the first lookup
+    // the body is received without growing a fresh string.
+    thread_local std::string response_string;
+    response_string.clear();
+    response_string.reserve(kResponseBufferBytes);
+    std::chrono::milliseconds retry_after(0);
+    const auto started = std::chrono::steady_clock::now();
+    const long status = Post(config, false, prompt, request_class, request, WriteCallback, &response_string, retry_after);
+    return ReadReply(config, request_class, status, response_string, retry_after, started);
+}
+
+std::string Translator::GenerateStream(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request, const PartialCallback &partial)
+{
+    struct StreamSink
+    {
+        SseTextStream stream;
+        const PartialCallback *partial;
+        std::string last_partial;
+    } sink{SseTextStream(), &partial, std::string()};
+
+    curl_write_callback on_data = [](char *contents, size_t size, size_t nmemb, void *userp) -> size_t
+    {
+        StreamSink *sink = static_cast<StreamSink *>(userp);
+        if (sink->stream.Feed(contents, size * nmemb) && *sink->partial)
+        {
+            std::string current;
+            if (ExtractPartialString(sink->stream.Text(), "persian_definition", current) && current != sink->last_partial)
+            {
+                sink->last_partial = current;
+                (*sink->partial)(current);
+            }
+        }
+        return size * nmemb;
+    };
+    std::chrono::milliseconds retry_after(0);
+    const long status = Post(config, true, prompt, request_class, request, on_data, &sink, retry_after);
+    if (ShouldRetry(status))
+        throw RetryableError("HTTP " + std::to_string(status) + ": " + sink.stream.Unparsed().substr(0, 200), retry_after);
+    if (status >= 400)
+        throw std::runtime_error("HTTP " + std::to_string(status) + ": " + sink.stream.Unparsed().substr(0, 200));
+
+    std::string text_str = sink.stream.Text();
+    if (text_str.empty())
+        throw std::runtime_error("Empty streaming response: " + sink.stream.Unparsed());
+    return text_str;
+}
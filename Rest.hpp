@@ -6,16 +6,261 @@
 #include <iomanip>
 #include <json.hpp>
 #include <fstream>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <Backend.hpp>
+#include <DiskCache.hpp>
+#include <KeyPool.hpp>
+#include <LruCache.hpp>
+#include <Metrics.hpp>
+#include <MultiTransport.hpp>
+#include <PromptProfile.hpp>
+#include <TextChunker.hpp>
+#include <RateLimiter.hpp>
+#include <TranslationResult.hpp>
+
+// Handle for a lookup queued with Translator::TranslateAsync. Cancelling
+// aborts the transfer if it is already running and suppresses the callback.
+class TranslationRequest
+{
+public:
+    TranslationRequest() = default;
+    // A child is also cancelled with its parent. Cancel the child before
+    // the parent goes away: the parent is only consulted while the child
+    // itself is not cancelled.
+    explicit TranslationRequest(const TranslationRequest *parent) : parent(parent) {}
+
+    void Cancel() { cancelled = true; }
+    bool IsCancelled() const { return cancelled || (parent && parent->IsCancelled()); }
+
+private:
+    const TranslationRequest *parent = nullptr;
+    std::atomic<bool> cancelled{false};
+};
+
+// Thrown when a lookup stops because its TranslationRequest was cancelled.
+class TranslationCancelled : public std::runtime_error
+{
+public:
+    TranslationCancelled() : std::runtime_error("Translation cancelled") {}
+};
+
+// A failure worth retrying: a transport error, HTTP 429 or a 5xx reply.
+class RetryableError : public std::runtime_error
+{
+public:
+    RetryableError(const std::string &what, std::chrono::milliseconds retry_after)
+        : std::runtime_error(what), retry_after(retry_after) {}
+
+    // Delay requested by the server through Retry-After, or zero.
+    std::chrono::milliseconds retry_after;
+};
+
+// Keeps the most recent request latencies to estimate percentiles.
+class LatencyTracker
+{
+public:
+    void Record(std::chrono::milliseconds latency);
+    size_t Count() const;
+    std::chrono::milliseconds Percentile(double p) const;
+
+private:
+    static constexpr size_t kWindow = 128;
+    mutable std::mutex mutex;
+    std::chrono::milliseconds samples[kWindow] = {};
+    size_t count = 0;
+    size_t next = 0;
+};
+
+// Receives diagnostics such as retries and batch fallbacks, on whichever
+// thread runs the lookup.
+using LogCallback = std::function<void(const std::string &message)>;
+
+// Settings a lookup reads. A Translator holds its current settings as one
+// immutable snapshot: setters build a modified copy and swap it in, and each
+// lookup takes the snapshot once when it starts and keeps it until it ends,
+// so settings changes never wait for running lookups or tear one halfway.
+struct TranslatorConfig
+{
+    std::string proxy;
+    std::shared_ptr<DiskCache> disk_cache;
+    std::shared_ptr<TranslationBackend> backends[2]; // Indexed by RequestClass.
+    PromptProfile profiles[2] = {PromptProfile::PersianOnly, PromptProfile::FullDictionary};
+    std::chrono::milliseconds connect_timeout{10000};
+    std::chrono::milliseconds total_timeout{60000};
+    int max_attempts = 3;
+    bool hedging = false;
+    LogCallback log;
+
+    const TranslationBackend &Backend(RequestClass request_class) const { return *backends[static_cast<int>(request_class)]; }
+    PromptProfile Profile(RequestClass request_class) const { return profiles[static_cast<int>(request_class)]; }
+};
+
+using ConfigSnapshot = std::shared_ptr<const TranslatorConfig>;
+
+// libcurl write callback that appends the received bytes to the
+// std::string passed as `userp`.
+size_t WriteCallback(char *contents, size_t size, size_t nmemb, void *userp);
+
+// Invoked on a worker thread with either the result or a non-empty error.
+using TranslateCallback = std::function<void(const TranslationResult &result, const std::string &error)>;
+// Invoked on a worker thread with the Persian translation received so far.
+using PartialCallback = std::function<void(const std::string &persian_definition)>;
 
 class Translator
 {
 public:
-    std::string Translate(std::string word);
+    Translator();
+    ~Translator();
+    Translator(const Translator &) = delete;
+    Translator &operator=(const Translator &) = delete;
+
+    TranslationResult Translate(std::string word, RequestClass request_class = RequestClass::Interactive);
+    std::shared_ptr<TranslationRequest> TranslateAsync(std::string word, TranslateCallback done, RequestClass request_class = RequestClass::Interactive);
+    // Like TranslateAsync, but uses streamGenerateContent and reports the
+    // Persian translation incrementally before `done` gets the full result.
+    // A lookup that joins one already in flight for the same word gets only
+    // the full result.
+    std::shared_ptr<TranslationRequest> TranslateStreamAsync(std::string word, PartialCallback partial, TranslateCallback done);
+    // For paragraphs and longer text: splits it at sentence boundaries and
+    // translates the chunks concurrently with the sentence profile.
+    // `partial` gets the translation of the leading chunks, in order, each
+    // time it grows; `done` gets the whole text as persian_definition, with
+    // untranslatable chunks left in the original.
+    std::shared_ptr<TranslationRequest> TranslateDocumentAsync(std::string text, PartialCallback partial, TranslateCallback done);
+    // Translates many inputs with as few requests as possible. Results keep
+    // the input order; an entry is empty if its lookup failed.
+    std::vector<std::optional<TranslationResult>> TranslateBatch(const std::vector<std::string> &words);
+    // Most inputs, and input characters, TranslateBatch packs into one
+    // request; the character cap is roughly 2k tokens at ~4 per token.
+    static constexpr size_t kBatchMaxItems = 32;
+    static constexpr size_t kBatchMaxInputChars = 8000;
     void setApiKey(std::string api_key);
+    // The first configured key, or empty if there is none.
     std::string getApiKey() const;
+    // Spreads requests across several keys; see KeyPool.
+    void setApiKeys(std::vector<std::string> api_keys);
+    std::vector<std::string> getApiKeys() const;
     void setProxy(std::string ip, std::string port);
+    void setConnectTimeout(std::chrono::milliseconds connect_timeout);
+    void setTotalTimeout(std::chrono::milliseconds total_timeout);
+    // Attempts per lookup, including the first one.
+    void setMaxAttempts(int max_attempts);
+    // When enabled, a second attempt is started if the first has not
+    // answered within the recently observed 95th percentile latency.
+    void setHedging(bool enabled);
+    // Diagnostics are dropped unless a callback is set; the library never
+    // writes to the process's stdout or stderr itself.
+    void setLogCallback(LogCallback log);
+    void setBackend(std::shared_ptr<TranslationBackend> backend);
+    void setBackend(std::shared_ptr<TranslationBackend> backend, RequestClass request_class);
+    // Defaults to PersianOnly for interactive lookups and FullDictionary
+    // for bulk work.
+    void setPromptProfile(PromptProfile profile);
+    void setPromptProfile(PromptProfile profile, RequestClass request_class);
+    void EnableDiskCache(const std::string &path, uint64_t max_bytes);
+    DiskCache::Stats GetDiskCacheStats() const;
+    // Visits the disk cache's results from the interactive backend for the
+    // current prompt version, most recent first, with the normalized input
+    // each one answers.
+    void ForEachCached(const std::function<void(const std::string &word, const TranslationResult &result)> &visit) const;
+    void setMemoryCacheLimit(size_t max_bytes);
+    LruCache::Stats GetMemoryCacheStats() const;
+    // Per-key quota shared by all lookups; 0 leaves that budget unlimited.
+    // Tokens are estimated from the prompt length.
+    void setRateLimits(double requests_per_minute, double tokens_per_minute);
+    // Lookups currently held back by the rate limiter.
+    RateLimiter::Stats GetSchedulerStats() const;
+    // The settings new lookups start with.
+    ConfigSnapshot GetConfig() const;
+    // Request timings and counters since construction.
+    const Metrics &GetMetrics() const;
 
 private:
-    std::string api_key;
-    std::string proxy;
+    class HandleLease;
+    struct Transfer;
+
+    // Copies the current settings, lets `modify` change the copy and
+    // publishes it for lookups that start afterwards.
+    void UpdateConfig(const std::function<void(TranslatorConfig &config)> &modify);
+
+    TranslationResult DoTranslate(const ConfigSnapshot &config, const std::string &word, RequestClass request_class, PromptProfile profile, const TranslationRequest *request);
+    TranslationResult SingleFlight(const std::string &cache_key, const TranslationRequest *request, const std::function<TranslationResult()> &fetch);
+    std::string Generate(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request);
+    std::string GenerateHedged(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request);
+    std::string GenerateOnce(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request);
+    std::string GenerateStream(const TranslatorConfig &config, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request, const PartialCallback &partial);
+    std::string WithRetries(const TranslatorConfig &config, const TranslationRequest *request, const std::function<std::string()> &attempt);
+    bool ShouldRetry(long status) const;
+    // Takes a key and a handle and configures the request; the transfer is
+    // ready to be started on the transport.
+    std::unique_ptr<Transfer> PrepareTransfer(const TranslatorConfig &config, bool stream, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request, curl_write_callback write, void *sink);
+    // Records the finished transfer and returns its HTTP status.
+    long FinishTransfer(Transfer &transfer, CURLcode res, std::chrono::milliseconds &retry_after);
+    long Post(const TranslatorConfig &config, bool stream, const Prompt &prompt, RequestClass request_class, const TranslationRequest *request, curl_write_callback write, void *sink, std::chrono::milliseconds &retry_after);
+    // Turns a non-streaming reply into the generated text, or throws.
+    std::string ReadReply(const TranslatorConfig &config, RequestClass request_class, long status, const std::string &response, std::chrono::milliseconds retry_after, std::chrono::steady_clock::time_point started);
+    // `count` is false for re-checks that should not show up as another
+    // lookup in the metrics.
+    bool LookupCached(const TranslatorConfig &config, const std::string &cache_key, TranslationResult &value, bool count = true);
+    void StoreCached(const TranslatorConfig &config, const std::string &cache_key, const TranslationResult &value);
+    TranslationResult ParseResult(const std::string &text);
+    void RecordTransfer(CURL *curl);
+    void Enqueue(std::function<void()> job, RequestClass request_class);
+    void StartWorkers();
+    void WorkerLoop();
+    static int OnTransferProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+
+    CURL *AcquireHandle();
+    void ReleaseHandle(CURL *curl);
+    static void LockShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr);
+    static void UnlockShare(CURL *handle, curl_lock_data data, void *userptr);
+
+    // Read with std::atomic_load and replaced with std::atomic_store, so
+    // lookups never take a lock for it. Writers serialize on
+    // config_write_mutex so concurrent updates don't lose each other.
+    ConfigSnapshot current_config;
+    std::mutex config_write_mutex;
+    LatencyTracker latencies;
+    KeyPool keys;
+    LruCache memory_cache;
+    RateLimiter rate_limiter;
+    Metrics metrics;
+
+    // Every transfer runs on the transport's event loop, which owns the
+    // connections; DNS entries and TLS sessions are shared as well so a new
+    // connection can skip the lookup and resume the TLS session.
+    std::unique_ptr<MultiTransport> transport;
+    CURLSH *share = nullptr;
+    std::mutex share_locks[CURL_LOCK_DATA_LAST];
+    std::mutex pool_mutex;
+    std::vector<CURL *> idle_handles;
+
+    // In-flight network lookups by cache key, so identical concurrent
+    // lookups share one request. Sharded to keep lock hold times short.
+    struct FlightShard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_future<TranslationResult>> flights;
+    };
+    static constexpr size_t kFlightShards = 16;
+    FlightShard flight_shards[kFlightShards];
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<std::function<void()>> jobs;
+    size_t interactive_jobs = 0; // Queued at the front of jobs.
+    std::vector<std::thread> workers;
+    bool stopping = false;
 };
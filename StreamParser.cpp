@@ -0,0 +1,163 @@
+#include <StreamParser.hpp>
+#include <ResponseParser.hpp>
+
+namespace
+{
+    void AppendUtf8(std::string &out, unsigned long cp)
+    {
+        if (cp < 0x80)
+        {
+            out += static_cast<char>(cp);
+        }
+        else if (cp < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool ParseHex4(const std::string &s, size_t pos, unsigned long &cp)
+    {
+        if (pos + 4 > s.size())
+            return false;
+        cp = 0;
+        for (size_t i = pos; i < pos + 4; ++i)
+        {
+            char c = s[i];
+            cp <<= 4;
+            if (c >= '0' && c <= '9')
+                cp |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                cp |= c - 'A' + 10;
+            else
+                return false;
+        }
+        return true;
+    }
+}
+
+bool SseTextStream::Feed(const char *data, size_t size)
+{
+    pending.append(data, size);
+    bool appended = false;
+    size_t start = 0;
+    for (size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', start))
+    {
+        std::string line = pending.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        appended |= ParseLine(line);
+        start = end + 1;
+    }
+    pending.erase(0, start);
+    return appended;
+}
+
+bool SseTextStream::ParseLine(const std::string &line)
+{
+    if (line.empty() || line[0] == ':')
+        return false;
+    if (line.compare(0, 5, "data:") != 0)
+    {
+        unparsed += line;
+        unparsed += '\n';
+        return false;
+    }
+
+    std::string chunk;
+    if (!ExtractCandidateText(std::string_view(line).substr(5), chunk))
+        return false;
+    text += chunk;
+    return !chunk.empty();
+}
+
+bool ExtractPartialString(const std::string &json_text, const std::string &field, std::string &value)
+{
+    const std::string quoted = "\"" + field + "\"";
+    size_t pos = json_text.find(quoted);
+    if (pos == std::string::npos)
+        return false;
+    pos += quoted.size();
+    while (pos < json_text.size() && (json_text[pos] == ' ' || json_text[pos] == '\n' || json_text[pos] == '\r' || json_text[pos] == '\t'))
+        ++pos;
+    if (pos >= json_text.size() || json_text[pos] != ':')
+        return false;
+    ++pos;
+    while (pos < json_text.size() && (json_text[pos] == ' ' || json_text[pos] == '\n' || json_text[pos] == '\r' || json_text[pos] == '\t'))
+        ++pos;
+    if (pos >= json_text.size() || json_text[pos] != '"')
+        return false;
+    ++pos;
+
+    value.clear();
+    while (pos < json_text.size())
+    {
+        char c = json_text[pos];
+        if (c == '"')
+            break;
+        if (c != '\\')
+        {
+            value += c;
+            ++pos;
+            continue;
+        }
+        if (pos + 1 >= json_text.size())
+            break; // Escape sequence split across chunks.
+        char e = json_text[pos + 1];
+        switch (e)
+        {
+        case 'n':
+            value += '\n';
+            break;
+        case 't':
+            value += '\t';
+            break;
+        case 'r':
+            value += '\r';
+            break;
+        case 'b':
+            value += '\b';
+            break;
+        case 'f':
+            value += '\f';
+            break;
+        case 'u':
+        {
+            unsigned long cp;
+            if (!ParseHex4(json_text, pos + 2, cp))
+                return true;
+            pos += 6;
+            if (cp >= 0xD800 && cp <= 0xDBFF)
+            {
+                unsigned long low;
+                if (pos + 1 >= json_text.size() || json_text[pos] != '\\' || json_text[pos + 1] != 'u' || !ParseHex4(json_text, pos + 2, low))
+                    return true;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                pos += 6;
+            }
+            AppendUtf8(value, cp);
+            continue;
+        }
+        default:
+            value += e;
+            break;
+        }
+        pos += 2;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Incremental reader for streamGenerateContent?alt=sse responses. Feed it
+// the raw bytes as they arrive; it concatenates the text of every
+// candidates[0].content.parts[0] chunk into Text().
+class SseTextStream
+{
+public:
+    // Returns true when the call appended new model text.
+    bool Feed(const char *data, size_t size);
+    const std::string &Text() const { return text; }
+    // Anything that was not an SSE data line, e.g. an HTTP error body.
+    const std::string &Unparsed() const { return unparsed; }
+
+private:
+    bool ParseLine(const std::string &line);
+
+    std::string pending;
+    std::string text;
+    std::string unparsed;
+};
+
+// Decodes the string value of `field` from possibly truncated JSON text,
+// stopping at the end of the input if the closing quote has not arrived.
+// Returns false if the field has not started yet.
+bool ExtractPartialString(const std::string &json_text, const std::string &field, std::string &value);
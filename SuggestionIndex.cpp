@@ -0,0 +1,206 @@
+#include <SuggestionIndex.hpp>
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    // Prefix matches gathered before picking the shortest ones.
+    const size_t kMaxPrefixCandidates = 256;
+    // Myers' algorithm keeps the pattern in one 64-bit word.
+    const size_t kMaxFuzzyLength = 64;
+    const size_t kFilterBlock = 1024;
+
+    // Branch-free popcount; the filter loop below stays cheap even without a
+    // hardware popcount instruction.
+    inline uint32_t CountBits(uint32_t x)
+    {
+        x = x - ((x >> 1) & 0x55555555u);
+        x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+        x = (x + (x >> 4)) & 0x0f0f0f0fu;
+        return (x * 0x01010101u) >> 24;
+    }
+
+    int MaxDistance(size_t length)
+    {
+        if (length < 3)
+            return 0;
+        return length < 5 ? 1 : 2;
+    }
+
+    // Levenshtein distance with the pattern's match masks precomputed; one
+    // pass of word-wide bit operations per text character (Myers 1999,
+    // Hyyrö's formulation). Gives up early once `max` is out of reach.
+    int BitParallelDistance(const uint64_t *peq, size_t m, const std::string &text, int max)
+    {
+        uint64_t pv = ~0ull;
+        uint64_t mv = 0;
+        const uint64_t last = 1ull << (m - 1);
+        int score = static_cast<int>(m);
+        const int n = static_cast<int>(text.size());
+        for (int j = 0; j < n; ++j)
+        {
+            const uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+            const uint64_t xv = eq | mv;
+            const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if (ph & last)
+                ++score;
+            else if (mh & last)
+                --score;
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+            // The final score can drop by at most one per remaining character.
+            if (score - (n - 1 - j) > max)
+                return max + 1;
+        }
+        return score;
+    }
+}
+
+uint32_t SuggestionIndex::LetterMask(const std::string &word)
+{
+    uint32_t mask = 0;
+    for (unsigned char c : word)
+        mask |= 1u << (c >= 'a' && c <= 'z' ? c - 'a' : 26 + (c & 3));
+    return mask;
+}
+
+void SuggestionIndex::Add(const std::string &word, const std::string &persian)
+{
+    if (word.empty() || persian.empty())
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto pos = std::lower_bound(sorted.begin(), sorted.end(), word, [this](uint32_t index, const std::string &w)
+                                { return entries[index].word < w; });
+    if (pos != sorted.end() && entries[*pos].word == word)
+    {
+        entries[*pos].persian = persian;
+        return;
+    }
+    sorted.insert(pos, Append(word, persian));
+}
+
+void SuggestionIndex::AddAll(std::vector<std::pair<std::string, std::string>> words)
+{
+    words.erase(std::remove_if(words.begin(), words.end(), [](const std::pair<std::string, std::string> &w)
+                               { return w.first.empty() || w.second.empty(); }),
+                words.end());
+    // Stable, so the first of several duplicates stays in front and unique
+    // keeps it.
+    std::stable_sort(words.begin(), words.end(), [](const std::pair<std::string, std::string> &a, const std::pair<std::string, std::string> &b)
+                     { return a.first < b.first; });
+    words.erase(std::unique(words.begin(), words.end(), [](const std::pair<std::string, std::string> &a, const std::pair<std::string, std::string> &b)
+                            { return a.first == b.first; }),
+                words.end());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<uint32_t> added;
+    for (auto &w : words)
+    {
+        auto pos = std::lower_bound(sorted.begin(), sorted.end(), w.first, [this](uint32_t index, const std::string &word)
+                                    { return entries[index].word < word; });
+        if (pos == sorted.end() || entries[*pos].word != w.first)
+            added.push_back(Append(std::move(w.first), std::move(w.second)));
+    }
+    // `added` is in word order already, so one merge keeps `sorted` sorted.
+    std::vector<uint32_t> merged;
+    merged.reserve(sorted.size() + added.size());
+    std::merge(sorted.begin(), sorted.end(), added.begin(), added.end(), std::back_inserter(merged), [this](uint32_t a, uint32_t b)
+               { return entries[a].word < entries[b].word; });
+    sorted.swap(merged);
+}
+
+uint32_t SuggestionIndex::Append(std::string word, std::string persian)
+{
+    const uint32_t index = static_cast<uint32_t>(entries.size());
+    const size_t length = word.size();
+    if (by_length.size() <= length)
+        by_length.resize(length + 1);
+    by_length[length].letters.push_back(LetterMask(word));
+    by_length[length].entries.push_back(index);
+    entries.push_back(Entry{std::move(word), std::move(persian)});
+    return index;
+}
+
+size_t SuggestionIndex::Size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+std::vector<SuggestionIndex::Suggestion> SuggestionIndex::Suggest(const std::string &query, size_t limit) const
+{
+    std::vector<Suggestion> results;
+    if (query.empty() || limit == 0)
+        return results;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<uint32_t> prefix;
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), query, [this](uint32_t index, const std::string &w)
+                               { return entries[index].word < w; });
+    for (; it != sorted.end() && prefix.size() < kMaxPrefixCandidates; ++it)
+    {
+        const std::string &word = entries[*it].word;
+        if (word.compare(0, query.size(), query) != 0)
+            break;
+        prefix.push_back(*it);
+    }
+    std::stable_sort(prefix.begin(), prefix.end(), [this](uint32_t a, uint32_t b)
+                     { return entries[a].word.size() < entries[b].word.size(); });
+    for (uint32_t index : prefix)
+    {
+        if (results.size() == limit)
+            return results;
+        results.push_back(Suggestion{entries[index].word, entries[index].persian, 0});
+    }
+
+    const int max = MaxDistance(query.size());
+    if (max == 0 || query.size() > kMaxFuzzyLength)
+        return results;
+
+    uint64_t peq[256] = {};
+    for (size_t i = 0; i < query.size(); ++i)
+        peq[static_cast<unsigned char>(query[i])] |= 1ull << i;
+    const uint32_t query_letters = LetterMask(query);
+
+    std::vector<std::pair<int, uint32_t>> fuzzy;
+    const size_t shortest = query.size() - std::min<size_t>(query.size(), max);
+    const size_t longest = std::min(by_length.empty() ? 0 : by_length.size() - 1, query.size() + max);
+    for (size_t length = shortest; length <= longest && length < by_length.size(); ++length)
+    {
+        const LengthBucket &bucket = by_length[length];
+        for (size_t start = 0; start < bucket.letters.size(); start += kFilterBlock)
+        {
+            // Each edit adds or removes at most two letters from the set. The
+            // filter runs branch-free over a block so the compiler can
+            // vectorize it; survivors are rare.
+            const size_t count = std::min(kFilterBlock, bucket.letters.size() - start);
+            const uint32_t *letters = bucket.letters.data() + start;
+            uint8_t keep[kFilterBlock];
+            for (size_t i = 0; i < count; ++i)
+                keep[i] = CountBits(letters[i] ^ query_letters) <= static_cast<uint32_t>(2 * max);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!keep[i])
+                    continue;
+                const uint32_t index = bucket.entries[start + i];
+                const Entry &entry = entries[index];
+                const int distance = BitParallelDistance(peq, query.size(), entry.word, max);
+                if (distance <= max && distance > 0 && entry.word.compare(0, query.size(), query) != 0)
+                    fuzzy.emplace_back(distance, index);
+            }
+        }
+    }
+    std::sort(fuzzy.begin(), fuzzy.end());
+    for (const auto &match : fuzzy)
+    {
+        if (results.size() == limit)
+            break;
+        const Entry &entry = entries[match.second];
+        results.push_back(Suggestion{entry.word, entry.persian, match.first});
+    }
+    return results;
+}
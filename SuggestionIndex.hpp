@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Words translated before, searchable by prefix and by edit distance so the
+// GUI can offer cached answers while the user is still typing. Prefix
+// matches come from a sorted array of the words; fuzzy matches scan only the
+// length buckets within reach, reject most words by comparing letter sets,
+// and run a bit-parallel (Myers) Levenshtein on the rest. A query over 100k
+// words stays well under a millisecond.
+class SuggestionIndex
+{
+public:
+    struct Suggestion
+    {
+        std::string word;
+        std::string persian;
+        int distance = 0; // 0 for prefix matches.
+    };
+
+    // `word` must already be normalized. Re-adding a word replaces its
+    // translation.
+    void Add(const std::string &word, const std::string &persian);
+    // Adds many words, sorting once rather than inserting one by one. Words
+    // already indexed keep their translation, and of duplicates within
+    // `words` the first wins, so history can be passed most recent first.
+    void AddAll(std::vector<std::pair<std::string, std::string>> words);
+    // Prefix matches first, shortest first; then words within one edit (two
+    // for queries of five or more characters), closest first.
+    std::vector<Suggestion> Suggest(const std::string &query, size_t limit) const;
+    size_t Size() const;
+
+private:
+    struct Entry
+    {
+        std::string word;
+        std::string persian;
+    };
+
+    // Words of one length. The letter sets sit in their own array so the
+    // fuzzy filter streams through memory instead of visiting every entry.
+    struct LengthBucket
+    {
+        std::vector<uint32_t> letters; // Bit per character class present.
+        std::vector<uint32_t> entries;
+    };
+
+    static uint32_t LetterMask(const std::string &word);
+    // Appends a new entry to `entries` and its length bucket, but not to
+    // `sorted`; returns its index.
+    uint32_t Append(std::string word, std::string persian);
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> sorted;                 // Entry indices ordered by word.
+    std::vector<LengthBucket> by_length; // Indexed by word length.
+};
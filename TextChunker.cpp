@@ -0,0 +1,148 @@
+#include <TextChunker.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace
+{
+    // Words that end in a period without ending the sentence.
+    const char *const kAbbreviations[] = {"mr", "mrs", "ms", "dr", "prof", "st", "vs", "etc", "e.g", "i.e", "jr", "sr", "no", "fig"};
+
+    bool IsSpace(char c)
+    {
+        return std::isspace(static_cast<unsigned char>(c)) != 0;
+    }
+
+    bool IsAbbreviation(const std::string &text, size_t period)
+    {
+        size_t start = period;
+        while (start > 0 && !IsSpace(text[start - 1]))
+            --start;
+        std::string word = text.substr(start, period - start);
+        std::transform(word.begin(), word.end(), word.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        if (word.size() == 1 && std::isalpha(static_cast<unsigned char>(word[0])))
+            return true; // An initial, as in "J. Smith".
+        for (const char *abbreviation : kAbbreviations)
+        {
+            if (word == abbreviation)
+                return true;
+        }
+        return false;
+    }
+
+    struct Sentence
+    {
+        size_t begin;
+        size_t end;
+        bool paragraph_end;
+        std::string separator;
+    };
+
+    std::vector<Sentence> FindSentences(const std::string &text)
+    {
+        std::vector<Sentence> sentences;
+        size_t begin = 0;
+        const size_t n = text.size();
+        while (begin < n && IsSpace(text[begin]))
+            ++begin;
+        size_t i = begin;
+        while (i < n)
+        {
+            const char c = text[i];
+            size_t end = std::string::npos;
+            if (c == '\n')
+            {
+                end = i;
+            }
+            else if (c == '.' || c == '!' || c == '?')
+            {
+                size_t close = i + 1;
+                while (close < n && std::strchr("\"')]", text[close]))
+                    ++close;
+                if ((close == n || IsSpace(text[close])) && !(c == '.' && IsAbbreviation(text, i)))
+                    end = close;
+            }
+            if (end == std::string::npos)
+            {
+                ++i;
+                continue;
+            }
+
+            size_t next = end;
+            size_t newlines = 0;
+            while (next < n && IsSpace(text[next]))
+                newlines += text[next++] == '\n';
+            size_t trimmed = end;
+            while (trimmed > begin && IsSpace(text[trimmed - 1]))
+                --trimmed;
+            if (trimmed > begin)
+                sentences.push_back(Sentence{begin, trimmed, newlines > 0, newlines > 1 ? "\n\n" : newlines == 1 ? "\n" : " "});
+            begin = i = next;
+        }
+        size_t trimmed = n;
+        while (trimmed > begin && IsSpace(text[trimmed - 1]))
+            --trimmed;
+        if (trimmed > begin)
+            sentences.push_back(Sentence{begin, trimmed, true, ""});
+        return sentences;
+    }
+
+    // Cuts at the last space within `max_chars`, or at a UTF-8 character
+    // boundary if the piece has no spaces.
+    void AppendOversized(const std::string &text, size_t max_chars, std::vector<TextChunk> &chunks)
+    {
+        size_t begin = 0;
+        while (text.size() - begin > max_chars)
+        {
+            size_t cut = text.rfind(' ', begin + max_chars);
+            if (cut == std::string::npos || cut <= begin)
+            {
+                cut = begin + max_chars;
+                while (cut > begin && (static_cast<unsigned char>(text[cut]) & 0xc0) == 0x80)
+                    --cut;
+            }
+            chunks.push_back(TextChunk{text.substr(begin, cut - begin), " "});
+            begin = cut;
+            while (begin < text.size() && text[begin] == ' ')
+                ++begin;
+        }
+        chunks.push_back(TextChunk{text.substr(begin), ""});
+    }
+}
+
+std::vector<TextChunk> SplitIntoChunks(const std::string &text, size_t max_chars)
+{
+    std::vector<TextChunk> chunks;
+    max_chars = std::max<size_t>(max_chars, 1);
+    TextChunk current;
+    for (const Sentence &sentence : FindSentences(text))
+    {
+        const std::string piece = text.substr(sentence.begin, sentence.end - sentence.begin);
+        if (!current.text.empty() && current.text.size() + 1 + piece.size() > max_chars)
+        {
+            chunks.push_back(std::move(current));
+            current = TextChunk();
+        }
+        if (piece.size() > max_chars)
+        {
+            AppendOversized(piece, max_chars, chunks);
+            chunks.back().separator = sentence.separator;
+            continue;
+        }
+        if (!current.text.empty())
+            current.text += current.separator;
+        current.text += piece;
+        current.separator = sentence.separator;
+        if (sentence.paragraph_end)
+        {
+            chunks.push_back(std::move(current));
+            current = TextChunk();
+        }
+    }
+    if (!current.text.empty())
+        chunks.push_back(std::move(current));
+    if (!chunks.empty())
+        chunks.back().separator.clear();
+    return chunks;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct TextChunk
+{
+    std::string text;
+    // Whitespace to put after this chunk's translation when reassembling:
+    // " ", "\n" or "\n\n", following the original layout.
+    std::string separator;
+};
+
+// Splits running text at sentence boundaries into chunks of at most
+// `max_chars` bytes, packing short sentences together. Paragraph breaks
+// always end a chunk; a sentence longer than `max_chars` is cut at the
+// last space that fits.
+std::vector<TextChunk> SplitIntoChunks(const std::string &text, size_t max_chars);
@@ -0,0 +1,395 @@
+#include <TextNormalize.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    struct Composition
+    {
+        uint16_t first;
+        uint16_t second;
+        uint16_t composed;
+    };
+
+    // Canonical compositions whose result is in Latin-1, Latin Extended-A/B
+    // or Arabic, sorted by (first, second). Generated from UnicodeData; this
+    // covers accented Latin letters and the hamza/madda forms Persian text
+    // arrives with, not the whole of NFC.
+    const Composition kCompositions[] = {
+        {0x0041, 0x0300, 0x00C0}, {0x0041, 0x0301, 0x00C1}, {0x0041, 0x0302, 0x00C2}, {0x0041, 0x0303, 0x00C3},
+        {0x0041, 0x0304, 0x0100}, {0x0041, 0x0306, 0x0102}, {0x0041, 0x0307, 0x0226}, {0x0041, 0x0308, 0x00C4},
+        {0x0041, 0x030A, 0x00C5}, {0x0041, 0x030C, 0x01CD}, {0x0041, 0x030F, 0x0200}, {0x0041, 0x0311, 0x0202},
+        {0x0041, 0x0328, 0x0104}, {0x0043, 0x0301, 0x0106}, {0x0043, 0x0302, 0x0108}, {0x0043, 0x0307, 0x010A},
+        {0x0043, 0x030C, 0x010C}, {0x0043, 0x0327, 0x00C7}, {0x0044, 0x030C, 0x010E}, {0x0045, 0x0300, 0x00C8},
+        {0x0045, 0x0301, 0x00C9}, {0x0045, 0x0302, 0x00CA}, {0x0045, 0x0304, 0x0112}, {0x0045, 0x0306, 0x0114},
+        {0x0045, 0x0307, 0x0116}, {0x0045, 0x0308, 0x00CB}, {0x0045, 0x030C, 0x011A}, {0x0045, 0x030F, 0x0204},
+        {0x0045, 0x0311, 0x0206}, {0x0045, 0x0327, 0x0228}, {0x0045, 0x0328, 0x0118}, {0x0047, 0x0301, 0x01F4},
+        {0x0047, 0x0302, 0x011C}, {0x0047, 0x0306, 0x011E}, {0x0047, 0x0307, 0x0120}, {0x0047, 0x030C, 0x01E6},
+        {0x0047, 0x0327, 0x0122}, {0x0048, 0x0302, 0x0124}, {0x0048, 0x030C, 0x021E}, {0x0049, 0x0300, 0x00CC},
+        {0x0049, 0x0301, 0x00CD}, {0x0049, 0x0302, 0x00CE}, {0x0049, 0x0303, 0x0128}, {0x0049, 0x0304, 0x012A},
+        {0x0049, 0x0306, 0x012C}, {0x0049, 0x0307, 0x0130}, {0x0049, 0x0308, 0x00CF}, {0x0049, 0x030C, 0x01CF},
+        {0x0049, 0x030F, 0x0208}, {0x0049, 0x0311, 0x020A}, {0x0049, 0x0328, 0x012E}, {0x004A, 0x0302, 0x0134},
+        {0x004B, 0x030C, 0x01E8}, {0x004B, 0x0327, 0x0136}, {0x004C, 0x0301, 0x0139}, {0x004C, 0x030C, 0x013D},
+        {0x004C, 0x0327, 0x013B}, {0x004E, 0x0300, 0x01F8}, {0x004E, 0x0301, 0x0143}, {0x004E, 0x0303, 0x00D1},
+        {0x004E, 0x030C, 0x0147}, {0x004E, 0x0327, 0x0145}, {0x004F, 0x0300, 0x00D2}, {0x004F, 0x0301, 0x00D3},
+        {0x004F, 0x0302, 0x00D4}, {0x004F, 0x0303, 0x00D5}, {0x004F, 0x0304, 0x014C}, {0x004F, 0x0306, 0x014E},
+        {0x004F, 0x0307, 0x022E}, {0x004F, 0x0308, 0x00D6}, {0x004F, 0x030B, 0x0150}, {0x004F, 0x030C, 0x01D1},
+        {0x004F, 0x030F, 0x020C}, {0x004F, 0x0311, 0x020E}, {0x004F, 0x031B, 0x01A0}, {0x004F, 0x0328, 0x01EA},
+        {0x0052, 0x0301, 0x0154}, {0x0052, 0x030C, 0x0158}, {0x0052, 0x030F, 0x0210}, {0x0052, 0x0311, 0x0212},
+        {0x0052, 0x0327, 0x0156}, {0x0053, 0x0301, 0x015A}, {0x0053, 0x0302, 0x015C}, {0x0053, 0x030C, 0x0160},
+        {0x0053, 0x0326, 0x0218}, {0x0053, 0x0327, 0x015E}, {0x0054, 0x030C, 0x0164}, {0x0054, 0x0326, 0x021A},
+        {0x0054, 0x0327, 0x0162}, {0x0055, 0x0300, 0x00D9}, {0x0055, 0x0301, 0x00DA}, {0x0055, 0x0302, 0x00DB},
+        {0x0055, 0x0303, 0x0168}, {0x0055, 0x0304, 0x016A}, {0x0055, 0x0306, 0x016C}, {0x0055, 0x0308, 0x00DC},
+        {0x0055, 0x030A, 0x016E}, {0x0055, 0x030B, 0x0170}, {0x0055, 0x030C, 0x01D3}, {0x0055, 0x030F, 0x0214},
+        {0x0055, 0x0311, 0x0216}, {0x0055, 0x031B, 0x01AF}, {0x0055, 0x0328, 0x0172}, {0x0057, 0x0302, 0x0174},
+        {0x0059, 0x0301, 0x00DD}, {0x0059, 0x0302, 0x0176}, {0x0059, 0x0304, 0x0232}, {0x0059, 0x0308, 0x0178},
+        {0x005A, 0x0301, 0x0179}, {0x005A, 0x0307, 0x017B}, {0x005A, 0x030C, 0x017D}, {0x0061, 0x0300, 0x00E0},
+        {0x0061, 0x0301, 0x00E1}, {0x0061, 0x0302, 0x00E2}, {0x0061, 0x0303, 0x00E3}, {0x0061, 0x0304, 0x0101},
+        {0x0061, 0x0306, 0x0103}, {0x0061, 0x0307, 0x0227}, {0x0061, 0x0308, 0x00E4}, {0x0061, 0x030A, 0x00E5},
+        {0x0061, 0x030C, 0x01CE}, {0x0061, 0x030F, 0x0201}, {0x0061, 0x0311, 0x0203}, {0x0061, 0x0328, 0x0105},
+        {0x0063, 0x0301, 0x0107}, {0x0063, 0x0302, 0x0109}, {0x0063, 0x0307, 0x010B}, {0x0063, 0x030C, 0x010D},
+        {0x0063, 0x0327, 0x00E7}, {0x0064, 0x030C, 0x010F}, {0x0065, 0x0300, 0x00E8}, {0x0065, 0x0301, 0x00E9},
+        {0x0065, 0x0302, 0x00EA}, {0x0065, 0x0304, 0x0113}, {0x0065, 0x0306, 0x0115}, {0x0065, 0x0307, 0x0117},
+        {0x0065, 0x0308, 0x00EB}, {0x0065, 0x030C, 0x011B}, {0x0065, 0x030F, 0x0205}, {0x0065, 0x0311, 0x0207},
+        {0x0065, 0x0327, 0x0229}, {0x0065, 0x0328, 0x0119}, {0x0067, 0x0301, 0x01F5}, {0x0067, 0x0302, 0x011D},
+        {0x0067, 0x0306, 0x011F}, {0x0067, 0x0307, 0x0121}, {0x0067, 0x030C, 0x01E7}, {0x0067, 0x0327, 0x0123},
+        {0x0068, 0x0302, 0x0125}, {0x0068, 0x030C, 0x021F}, {0x0069, 0x0300, 0x00EC}, {0x0069, 0x0301, 0x00ED},
+        {0x0069, 0x0302, 0x00EE}, {0x0069, 0x0303, 0x0129}, {0x0069, 0x0304, 0x012B}, {0x0069, 0x0306, 0x012D},
+        {0x0069, 0x0308, 0x00EF}, {0x0069, 0x030C, 0x01D0}, {0x0069, 0x030F, 0x0209}, {0x0069, 0x0311, 0x020B},
+        {0x0069, 0x0328, 0x012F}, {0x006A, 0x0302, 0x0135}, {0x006A, 0x030C, 0x01F0}, {0x006B, 0x030C, 0x01E9},
+        {0x006B, 0x0327, 0x0137}, {0x006C, 0x0301, 0x013A}, {0x006C, 0x030C, 0x013E}, {0x006C, 0x0327, 0x013C},
+        {0x006E, 0x0300, 0x01F9}, {0x006E, 0x0301, 0x0144}, {0x006E, 0x0303, 0x00F1}, {0x006E, 0x030C, 0x0148},
+        {0x006E, 0x0327, 0x0146}, {0x006F, 0x0300, 0x00F2}, {0x006F, 0x0301, 0x00F3}, {0x006F, 0x0302, 0x00F4},
+        {0x006F, 0x0303, 0x00F5}, {0x006F, 0x0304, 0x014D}, {0x006F, 0x0306, 0x014F}, {0x006F, 0x0307, 0x022F},
+        {0x006F, 0x0308, 0x00F6}, {0x006F, 0x030B, 0x0151}, {0x006F, 0x030C, 0x01D2}, {0x006F, 0x030F, 0x020D},
+        {0x006F, 0x0311, 0x020F}, {0x006F, 0x031B, 0x01A1}, {0x006F, 0x0328, 0x01EB}, {0x0072, 0x0301, 0x0155},
+        {0x0072, 0x030C, 0x0159}, {0x0072, 0x030F, 0x0211}, {0x0072, 0x0311, 0x0213}, {0x0072, 0x0327, 0x0157},
+        {0x0073, 0x0301, 0x015B}, {0x0073, 0x0302, 0x015D}, {0x0073, 0x030C, 0x0161}, {0x0073, 0x0326, 0x0219},
+        {0x0073, 0x0327, 0x015F}, {0x0074, 0x030C, 0x0165}, {0x0074, 0x0326, 0x021B}, {0x0074, 0x0327, 0x0163},
+        {0x0075, 0x0300, 0x00F9}, {0x0075, 0x0301, 0x00FA}, {0x0075, 0x0302, 0x00FB}, {0x0075, 0x0303, 0x0169},
+        {0x0075, 0x0304, 0x016B}, {0x0075, 0x0306, 0x016D}, {0x0075, 0x0308, 0x00FC}, {0x0075, 0x030A, 0x016F},
+        {0x0075, 0x030B, 0x0171}, {0x0075, 0x030C, 0x01D4}, {0x0075, 0x030F, 0x0215}, {0x0075, 0x0311, 0x0217},
+        {0x0075, 0x031B, 0x01B0}, {0x0075, 0x0328, 0x0173}, {0x0077, 0x0302, 0x0175}, {0x0079, 0x0301, 0x00FD},
+        {0x0079, 0x0302, 0x0177}, {0x0079, 0x0304, 0x0233}, {0x0079, 0x0308, 0x00FF}, {0x007A, 0x0301, 0x017A},
+        {0x007A, 0x0307, 0x017C}, {0x007A, 0x030C, 0x017E}, {0x00C4, 0x0304, 0x01DE}, {0x00C5, 0x0301, 0x01FA},
+        {0x00C6, 0x0301, 0x01FC}, {0x00C6, 0x0304, 0x01E2}, {0x00D5, 0x0304, 0x022C}, {0x00D6, 0x0304, 0x022A},
+        {0x00D8, 0x0301, 0x01FE}, {0x00DC, 0x0300, 0x01DB}, {0x00DC, 0x0301, 0x01D7}, {0x00DC, 0x0304, 0x01D5},
+        {0x00DC, 0x030C, 0x01D9}, {0x00E4, 0x0304, 0x01DF}, {0x00E5, 0x0301, 0x01FB}, {0x00E6, 0x0301, 0x01FD},
+        {0x00E6, 0x0304, 0x01E3}, {0x00F5, 0x0304, 0x022D}, {0x00F6, 0x0304, 0x022B}, {0x00F8, 0x0301, 0x01FF},
+        {0x00FC, 0x0300, 0x01DC}, {0x00FC, 0x0301, 0x01D8}, {0x00FC, 0x0304, 0x01D6}, {0x00FC, 0x030C, 0x01DA},
+        {0x01B7, 0x030C, 0x01EE}, {0x01EA, 0x0304, 0x01EC}, {0x01EB, 0x0304, 0x01ED}, {0x0226, 0x0304, 0x01E0},
+        {0x0227, 0x0304, 0x01E1}, {0x022E, 0x0304, 0x0230}, {0x022F, 0x0304, 0x0231}, {0x0292, 0x030C, 0x01EF},
+        {0x0627, 0x0653, 0x0622}, {0x0627, 0x0654, 0x0623}, {0x0627, 0x0655, 0x0625}, {0x0648, 0x0654, 0x0624},
+        {0x064A, 0x0654, 0x0626}, {0x06C1, 0x0654, 0x06C2}, {0x06D2, 0x0654, 0x06D3}, {0x06D5, 0x0654, 0x06C0},
+    };
+
+    bool IsCombiningMark(uint32_t cp)
+    {
+        return (cp >= 0x0300 && cp <= 0x036F) || (cp >= 0x0653 && cp <= 0x0655);
+    }
+
+    uint32_t Compose(uint32_t first, uint32_t second)
+    {
+        if (first > 0xFFFF || second > 0xFFFF)
+            return 0;
+        const Composition key{static_cast<uint16_t>(first), static_cast<uint16_t>(second), 0};
+        const Composition *end = kCompositions + sizeof(kCompositions) / sizeof(kCompositions[0]);
+        const Composition *it = std::lower_bound(kCompositions, end, key, [](const Composition &a, const Composition &b)
+                                                 { return a.first != b.first ? a.first < b.first : a.second < b.second; });
+        return (it != end && it->first == first && it->second == second) ? it->composed : 0;
+    }
+
+    bool IsLineBreak(uint32_t cp)
+    {
+        return cp == 0x0A || cp == 0x0B || cp == 0x0C || cp == 0x0D || cp == 0x85 || cp == 0x2028 || cp == 0x2029;
+    }
+
+    bool IsSpace(uint32_t cp)
+    {
+        return cp == 0x09 || cp == 0x20 || cp == 0xA0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A) ||
+               cp == 0x202F || cp == 0x205F || cp == 0x3000 || IsLineBreak(cp);
+    }
+
+    // Controls and invisible format characters that only make otherwise
+    // equal inputs differ. ZWNJ and ZWJ (U+200C/D) stay: Persian spelling
+    // depends on them.
+    bool IsIgnorable(uint32_t cp)
+    {
+        return cp < 0x20 || (cp >= 0x7F && cp <= 0x9F) || cp == 0xAD || cp == 0x200B || cp == 0x200E ||
+               cp == 0x200F || (cp >= 0x202A && cp <= 0x202E) || cp == 0x2060 || (cp >= 0x2066 && cp <= 0x2069) ||
+               cp == 0xFEFF;
+    }
+
+    uint32_t ToLower(uint32_t cp)
+    {
+        if ((cp >= 'A' && cp <= 'Z') || (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7))
+            return cp + 0x20;
+        if (cp >= 0x100 && cp <= 0x17F && cp != 0x130 && cp != 0x131 && cp != 0x138 && cp != 0x149 && cp != 0x178 && cp != 0x17F)
+        {
+            // Latin Extended-A pairs upper/lower case on even/odd code points,
+            // shifted by one in 0x139-0x148 and 0x179-0x17E.
+            const bool shifted = (cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E);
+            return ((cp & 1) == (shifted ? 1u : 0u)) ? cp + 1 : cp;
+        }
+        return cp;
+    }
+
+    // Decodes one code point starting at text[i]; returns false (and skips
+    // one byte) on malformed, overlong or surrogate sequences.
+    bool DecodeUtf8(const std::string &text, size_t &i, uint32_t &cp)
+    {
+        const unsigned char lead = static_cast<unsigned char>(text[i]);
+        size_t length;
+        uint32_t min;
+        if (lead < 0x80)
+        {
+            cp = lead;
+            ++i;
+            return true;
+        }
+        if ((lead & 0xE0) == 0xC0)
+        {
+            length = 2;
+            cp = lead & 0x1F;
+            min = 0x80;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            length = 3;
+            cp = lead & 0x0F;
+            min = 0x800;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            length = 4;
+            cp = lead & 0x07;
+            min = 0x10000;
+        }
+        else
+        {
+            ++i;
+            return false;
+        }
+        if (i + length > text.size())
+        {
+            ++i;
+            return false;
+        }
+        for (size_t k = 1; k < length; ++k)
+        {
+            const unsigned char c = static_cast<unsigned char>(text[i + k]);
+            if ((c & 0xC0) != 0x80)
+            {
+                ++i;
+                return false;
+            }
+            cp = (cp << 6) | (c & 0x3F);
+        }
+        if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+        {
+            ++i;
+            return false;
+        }
+        i += length;
+        return true;
+    }
+
+    void AppendUtf8(std::string &out, uint32_t cp)
+    {
+        if (cp < 0x80)
+        {
+            out += static_cast<char>(cp);
+        }
+        else if (cp < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // True if every byte is printable ASCII or a plain space, so no
+    // decoding, composition or control removal is needed. Checks eight
+    // bytes per step.
+    bool IsPlainAscii(const std::string &text)
+    {
+        const uint64_t kHigh = 0x8080808080808080ull;
+        const uint64_t kOnes = 0x0101010101010101ull;
+        size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8)
+        {
+            uint64_t v;
+            std::memcpy(&v, text.data() + i, sizeof(v));
+            // High bit set, a byte below 0x20 (v - 0x20 borrows), or 0x7F
+            // (v + 1 carries into the high bit).
+            if (((v | (v - kOnes * 0x20) | (v + kOnes)) & kHigh) != 0)
+                return false;
+        }
+        for (; i < text.size(); ++i)
+        {
+            const unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c < 0x20 || c >= 0x7F)
+                return false;
+        }
+        return true;
+    }
+
+    enum class Mode
+    {
+        Input, // Keeps case and line breaks.
+        Key    // Lowercased, every whitespace run becomes one space.
+    };
+
+    // Writes at most max_bytes, never splitting a character.
+    class Writer
+    {
+    public:
+        Writer(Mode mode, size_t max_bytes) : mode(mode), max_bytes(max_bytes) {}
+
+        void Add(uint32_t cp)
+        {
+            if (IsSpace(cp))
+            {
+                if (IsLineBreak(cp) && !(cp == 0x0A && previous == 0x0D))
+                    ++pending_breaks;
+                pending_space = true;
+                previous = cp;
+                return;
+            }
+            previous = cp;
+            if (IsIgnorable(cp))
+                return;
+            if (mode == Mode::Key)
+                cp = ToLower(cp);
+            if (IsCombiningMark(cp) && starter)
+            {
+                if (const uint32_t composed = Compose(starter, cp))
+                {
+                    starter = mode == Mode::Key ? ToLower(composed) : composed;
+                    return;
+                }
+            }
+            Flush();
+            if (pending_space && !out.empty())
+            {
+                if (mode == Mode::Key || pending_breaks == 0)
+                    Emit(' ');
+                else
+                    for (size_t k = 0; k < std::min<size_t>(pending_breaks, 2); ++k)
+                        Emit('\n');
+            }
+            pending_space = false;
+            pending_breaks = 0;
+            starter = cp;
+        }
+
+        std::string Finish()
+        {
+            Flush();
+            return std::move(out);
+        }
+
+        bool Full() const { return full; }
+
+    private:
+        void Flush()
+        {
+            if (starter)
+                Emit(starter);
+            starter = 0;
+        }
+
+        void Emit(uint32_t cp)
+        {
+            if (full)
+                return;
+            const size_t before = out.size();
+            AppendUtf8(out, cp);
+            if (out.size() > max_bytes)
+            {
+                out.resize(before);
+                full = true;
+            }
+        }
+
+        Mode mode;
+        size_t max_bytes;
+        std::string out;
+        uint32_t starter = 0;  // Last character, held back for composition.
+        uint32_t previous = 0; // Last code point seen, to fold CRLF.
+        bool pending_space = false;
+        size_t pending_breaks = 0;
+        bool full = false;
+    };
+
+    std::string Normalize(const std::string &text, Mode mode, size_t max_bytes)
+    {
+        if (IsPlainAscii(text))
+        {
+            std::string out;
+            out.reserve(std::min(text.size(), max_bytes));
+            bool pending_space = false;
+            for (char c : text)
+            {
+                if (c == ' ')
+                {
+                    pending_space = !out.empty();
+                    continue;
+                }
+                if (pending_space)
+                    out += ' ';
+                pending_space = false;
+                out += (mode == Mode::Key && c >= 'A' && c <= 'Z') ? static_cast<char>(c + 0x20) : c;
+            }
+            if (out.size() > max_bytes)
+                out.resize(max_bytes);
+            while (!out.empty() && out.back() == ' ')
+                out.pop_back();
+            return out;
+        }
+
+        Writer writer(mode, max_bytes);
+        size_t i = 0;
+        while (i < text.size() && !writer.Full())
+        {
+            uint32_t cp;
+            if (DecodeUtf8(text, i, cp))
+                writer.Add(cp);
+        }
+        std::string out = writer.Finish();
+        while (!out.empty() && (out.back() == ' ' || out.back() == '\n'))
+            out.pop_back();
+        return out;
+    }
+}
+
+std::string SanitizeInput(const std::string &text, size_t max_bytes)
+{
+    return Normalize(text, Mode::Input, max_bytes);
+}
+
+std::string NormalizeKey(const std::string &word)
+{
+    return Normalize(word, Mode::Key, SIZE_MAX);
+}
+
+size_t CountCharacters(const std::string &text)
+{
+    size_t count = 0;
+    for (unsigned char c : text)
+        count += (c & 0xC0) != 0x80;
+    return count;
+}
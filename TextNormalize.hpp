@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Longest input sent for translation; long enough for a pasted page.
+const size_t kMaxInputBytes = 16 * 1024;
+
+// Cleans UTF-8 text typed or pasted by the user before it is sent for
+// translation: drops malformed bytes, control and invisible format
+// characters, composes accented Latin letters and Arabic hamza/madda forms
+// (the common cases of NFC), collapses spaces, keeps at most two line
+// breaks in a row, trims, and caps the length at a character boundary. The
+// GUI, the hotkey prefetch and the clipboard watcher all go through here so
+// the same text always maps to the same cache entry.
+std::string SanitizeInput(const std::string &text, size_t max_bytes = kMaxInputBytes);
+
+// Canonical form used to key caches and the offline dictionary: the same
+// cleaning as SanitizeInput, in a single pass, with Latin letters lowercased
+// and every whitespace run, line breaks included, turned into one space.
+std::string NormalizeKey(const std::string &word);
+
+// Code points in valid UTF-8 text, such as SanitizeInput returns; for
+// limits the user sees in characters rather than bytes.
+size_t CountCharacters(const std::string &text);
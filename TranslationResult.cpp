@@ -0,0 +1,87 @@
+#include <TranslationResult.hpp>
+#include <stdexcept>
+using json = nlohmann::json;
+
+namespace
+{
+    std::string StringField(const json &j, const char *name)
+    {
+        auto it = j.find(name);
+        return (it != j.end() && it->is_string()) ? it->get<std::string>() : std::string();
+    }
+
+    std::vector<std::string> StringListField(const json &j, const char *name)
+    {
+        std::vector<std::string> values;
+        auto it = j.find(name);
+        if (it == j.end())
+            return values;
+        if (it->is_string())
+        {
+            values.push_back(it->get<std::string>());
+            return values;
+        }
+        if (!it->is_array())
+            return values;
+        values.reserve(it->size());
+        for (const json &item : *it)
+        {
+            if (item.is_string())
+                values.push_back(item.get<std::string>());
+        }
+        return values;
+    }
+}
+
+TranslationResult TranslationResult::FromJson(const json &j)
+{
+    TranslationResult result;
+    if (!j.is_object())
+        return result;
+    result.type = StringField(j, "type");
+    result.word = StringField(j, "word");
+    result.definition = StringField(j, "definition");
+    result.examples = StringListField(j, "examples");
+    result.pronunciation = StringField(j, "pronunciation");
+    result.persian_definition = StringField(j, "persian_definition");
+    result.synonyms = StringListField(j, "synonyms");
+    result.acronym = StringField(j, "acronym");
+    return result;
+}
+
+TranslationResult TranslationResult::Parse(std::string_view text)
+{
+    json j = json::parse(text.begin(), text.end(), nullptr, false);
+    if (j.is_discarded() || !j.is_object())
+        throw std::runtime_error("Error parsing API response (invalid JSON): " + std::string(text));
+    return FromJson(j);
+}
+
+json TranslationResult::ToJson() const
+{
+    return json{
+        {"type", type},
+        {"word", word},
+        {"definition", definition},
+        {"examples", examples},
+        {"pronunciation", pronunciation},
+        {"persian_definition", persian_definition},
+        {"synonyms", synonyms},
+        {"acronym", acronym}};
+}
+
+std::string TranslationResult::Serialize() const
+{
+    return ToJson().dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+size_t TranslationResult::ByteSize() const
+{
+    size_t size = sizeof(TranslationResult) + type.size() + word.size() + definition.size() +
+                  pronunciation.size() + persian_definition.size() + acronym.size();
+    for (const std::string &example : examples)
+        size += sizeof(std::string) + example.size();
+    for (const std::string &synonym : synonyms)
+        size += sizeof(std::string) + synonym.size();
+    return size;
+}
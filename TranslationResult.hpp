@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <json.hpp>
+
+// One dictionary entry as returned by the model. Filled once while the
+// response is parsed and shared by the GUI, the caches and the CLI.
+struct TranslationResult
+{
+    std::string type;
+    std::string word;
+    std::string definition;
+    std::vector<std::string> examples;
+    std::string pronunciation;
+    std::string persian_definition;
+    std::vector<std::string> synonyms;
+    std::string acronym;
+
+    // Missing or mistyped fields are left empty.
+    static TranslationResult FromJson(const nlohmann::json &j);
+    // Parses the model's JSON text; throws std::runtime_error if it is not
+    // a JSON object.
+    static TranslationResult Parse(std::string_view text);
+
+    nlohmann::json ToJson() const;
+    std::string Serialize() const;
+    // Approximate heap footprint, used for cache budgets.
+    size_t ByteSize() const;
+};
@@ -0,0 +1,389 @@
+// Benchmarks for the request/response hot path: building the prompt and
+// payload, receiving and parsing a reply, and whole lookups against the
+// in-process mock server at several concurrency levels.
+//
+// Usage: translatur-bench [--filter TEXT] [--min-time MS] [--requests N] [--mock-latency MS]
+//
+// Every line reports time per operation, plus heap allocations and bytes
+// allocated per operation, counted by replacing the global operator new.
+// Replies are recorded Gemini responses, so runs are comparable across
+// changes to the Translator internals.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <MockServer.hpp>
+#include <PromptProfile.hpp>
+#include <ResponseParser.hpp>
+#include <Rest.hpp>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace
+{
+    std::atomic<uint64_t> g_allocations{0};
+    std::atomic<uint64_t> g_allocated_bytes{0};
+
+    void *CountedAlloc(std::size_t size, std::size_t alignment) noexcept
+    {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (size == 0)
+            size = 1;
+        if (alignment <= alignof(std::max_align_t))
+            return std::malloc(size);
+#ifdef _WIN32
+        return _aligned_malloc(size, alignment);
+#else
+        // aligned_alloc wants the size to be a multiple of the alignment.
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void CountedFree(void *p, std::size_t alignment) noexcept
+    {
+#ifdef _WIN32
+        if (alignment > alignof(std::max_align_t))
+        {
+            _aligned_free(p);
+            return;
+        }
+#else
+        (void)alignment;
+#endif
+        std::free(p);
+    }
+
+    void *CountedNew(std::size_t size, std::size_t alignment)
+    {
+        if (void *p = CountedAlloc(size, alignment))
+            return p;
+        throw std::bad_alloc();
+    }
+}
+
+// The whole replaceable family goes through the same two functions, so
+// every allocation is counted and every pointer is freed the way it was
+// allocated.
+void *operator new(std::size_t size) { return CountedNew(size, 0); }
+void *operator new[](std::size_t size) { return CountedNew(size, 0); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return CountedNew(size, static_cast<std::size_t>(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return CountedNew(size, static_cast<std::size_t>(alignment)); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return CountedAlloc(size, 0); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return CountedAlloc(size, 0); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return CountedAlloc(size, static_cast<std::size_t>(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return CountedAlloc(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void *p) noexcept { CountedFree(p, 0); }
+void operator delete[](void *p) noexcept { CountedFree(p, 0); }
+void operator delete(void *p, std::size_t) noexcept { CountedFree(p, 0); }
+void operator delete[](void *p, std::size_t) noexcept { CountedFree(p, 0); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { CountedFree(p, 0); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { CountedFree(p, 0); }
+void operator delete(void *p, std::align_val_t alignment) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+void operator delete[](void *p, std::align_val_t alignment) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+void operator delete(void *p, std::size_t, std::align_val_t alignment) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+void operator delete[](void *p, std::size_t, std::align_val_t alignment) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+void operator delete(void *p, std::align_val_t alignment, const std::nothrow_t &) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+void operator delete[](void *p, std::align_val_t alignment, const std::nothrow_t &) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+
+namespace
+{
+    // Recorded generateContent replies: JSON mode with the persian-only and
+    // full-dictionary profiles.
+    const char *const kPersianOnlyReply = R"({
+  "candidates": [
+    {
+      "content": {
+        "parts": [
+          {
+            "text": "{\"type\": \"word\", \"persian_definition\": \"خوش‌شانسی، یافتن چیزهای خوب به طور تصادفی\"}"
+          }
+        ],
+        "role": "model"
+      },
+      "finishReason": "STOP",
+      "avgLogprobs": -0.0721
+    }
+  ],
+  "usageMetadata": {
+    "promptTokenCount": 74,
+    "candidatesTokenCount": 31,
+    "totalTokenCount": 105,
+    "promptTokensDetails": [{"modality": "TEXT", "tokenCount": 74}],
+    "candidatesTokensDetails": [{"modality": "TEXT", "tokenCount": 31}]
+  },
+  "modelVersion": "gemini-2.0-flash",
+  "responseId": "b3Jx6kTqNvWd1e8Pq8a5-Ak"
+})";
+
+    const char *const kFullDictionaryReply = R"({
+  "candidates": [
+    {
+      "content": {
+        "parts": [
+          {
+            "text": "{\"type\": \"word\", \"word\": \"serendipity\", \"definition\": \"The occurrence and development of events by chance in a happy or beneficial way.\", \"examples\": [\"A fortunate stroke of serendipity brought the two old friends together.\", \"The discovery of penicillin was a famous case of serendipity.\", \"She found the book by pure serendipity while browsing.\"], \"pronunciation\": \"/ˌsɛɹənˈdɪpɪti/\", \"persian_definition\": \"خوش‌شانسی، یافتن چیزهای خوب به طور تصادفی\", \"synonyms\": [\"chance\", \"fluke\", \"luck\", \"fortune\", \"happy accident\"], \"acronym\": \"\"}"
+          }
+        ],
+        "role": "model"
+      },
+      "finishReason": "STOP",
+      "avgLogprobs": -0.1533
+    }
+  ],
+  "usageMetadata": {
+    "promptTokenCount": 212,
+    "candidatesTokenCount": 148,
+    "totalTokenCount": 360,
+    "promptTokensDetails": [{"modality": "TEXT", "tokenCount": 212}],
+    "candidatesTokensDetails": [{"modality": "TEXT", "tokenCount": 148}]
+  },
+  "modelVersion": "gemini-2.0-flash",
+  "responseId": "kXJx6o2vLsKd1e8PmYrE0Qs"
+})";
+
+    struct Options
+    {
+        std::string filter;
+        std::chrono::milliseconds min_time{300};
+        size_t requests = 2000;
+        int mock_latency_ms = 0;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "Usage: translatur-bench [--filter TEXT] [--min-time MS] [--requests N] [--mock-latency MS]\n"
+                     "--filter runs only benchmarks whose name contains TEXT.\n"
+                     "--min-time is how long each micro-benchmark runs (default 300).\n"
+                     "--requests is the number of lookups per mock server run (default 2000).\n";
+    }
+
+    bool ParseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--filter" && i + 1 < argc)
+                options.filter = argv[++i];
+            else if (arg == "--min-time" && i + 1 < argc)
+                options.min_time = std::chrono::milliseconds(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--requests" && i + 1 < argc)
+                options.requests = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--mock-latency" && i + 1 < argc)
+                options.mock_latency_ms = std::max(0, std::atoi(argv[++i]));
+            else
+                return false;
+        }
+        return true;
+    }
+
+    // Keeps results observable so the compiler cannot drop the work.
+    volatile size_t g_sink = 0;
+
+    struct AllocationCount
+    {
+        uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+        uint64_t bytes = g_allocated_bytes.load(std::memory_order_relaxed);
+    };
+
+    // Runs `body` (which returns some size derived from its work) in growing
+    // batches until the batch takes at least min_time, then reports that
+    // batch. `bytes_per_op` adds a throughput column when non-zero.
+    template <typename Body>
+    void Run(const Options &options, const std::string &name, size_t bytes_per_op, Body body)
+    {
+        if (name.find(options.filter) == std::string::npos)
+            return;
+        g_sink = g_sink + body();
+        for (uint64_t iterations = 1;; iterations *= 2)
+        {
+            const AllocationCount before;
+            const auto started = std::chrono::steady_clock::now();
+            size_t sink = 0;
+            for (uint64_t i = 0; i < iterations; ++i)
+                sink += body();
+            const auto elapsed = std::chrono::steady_clock::now() - started;
+            const AllocationCount after;
+            g_sink = g_sink + sink;
+            if (elapsed < options.min_time && iterations < (uint64_t(1) << 40))
+                continue;
+
+            const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-34s %12.1f ns/op %8.2f allocs/op %10.1f B/op",
+                          name.c_str(), ns,
+                          static_cast<double>(after.allocations - before.allocations) / static_cast<double>(iterations),
+                          static_cast<double>(after.bytes - before.bytes) / static_cast<double>(iterations));
+            std::cout << line;
+            if (bytes_per_op > 0)
+            {
+                std::snprintf(line, sizeof(line), " %9.1f MB/s", static_cast<double>(bytes_per_op) * 1e3 / ns);
+                std::cout << line;
+            }
+            std::cout << std::endl;
+            return;
+        }
+    }
+
+    void RunMicroBenchmarks(const Options &options)
+    {
+        GeminiBackend backend("gemini-2.0-flash");
+        const std::string word = "serendipity";
+        const std::string sentence = "The discovery of penicillin is often described as a happy accident, but it took years of work to turn it into a medicine.";
+
+        Run(options, "prompt/persian-only", 0, [&]
+            { return BuildPrompt(PromptProfile::PersianOnly, word).text.size(); });
+        Run(options, "prompt/full-dictionary", 0, [&]
+            { return BuildPrompt(PromptProfile::FullDictionary, word).text.size(); });
+        Run(options, "prompt/sentence", 0, [&]
+            { return BuildPrompt(PromptProfile::Sentence, sentence).text.size(); });
+
+        const Prompt prompt = BuildPrompt(PromptProfile::FullDictionary, word);
+        const size_t body_size = backend.BuildBody(prompt.text, prompt.response_schema).size();
+        Run(options, "payload/build-body", body_size, [&]
+            { return backend.BuildBody(prompt.text, prompt.response_schema).size(); });
+        Run(options, "payload/build-url", 0, [&]
+            { return backend.BuildUrl("AIzaSyD-benchmark-key-0000000000000000", false).size(); });
+
+        // curl hands the body over in pieces; replay the reply in small ones
+        // to count the per-call overhead too.
+        const std::string reply = kFullDictionaryReply;
+        const size_t kPiece = 256;
+        Run(options, "receive/write-callback-reused", reply.size(), [&]
+            {
+            thread_local std::string buffer;
+            buffer.clear();
+            buffer.reserve(16 * 1024);
+            for (size_t offset = 0; offset < reply.size(); offset += kPiece)
+                WriteCallback(const_cast<char *>(reply.data()) + offset, 1, std::min(kPiece, reply.size() - offset), &buffer);
+            return buffer.size(); });
+        Run(options, "receive/write-callback-fresh", reply.size(), [&]
+            {
+            std::string buffer;
+            for (size_t offset = 0; offset < reply.size(); offset += kPiece)
+                WriteCallback(const_cast<char *>(reply.data()) + offset, 1, std::min(kPiece, reply.size() - offset), &buffer);
+            return buffer.size(); });
+
+        const std::string short_reply = kPersianOnlyReply;
+        std::string text;
+        Run(options, "envelope/extract-persian-only", short_reply.size(), [&]
+            {
+            ExtractCandidateText(short_reply, text);
+            return text.size(); });
+        Run(options, "envelope/extract-full", reply.size(), [&]
+            {
+            ExtractCandidateText(reply, text);
+            return text.size(); });
+        // What the envelope parse cost before the SAX extractor.
+        Run(options, "envelope/dom-parse-full", reply.size(), [&]
+            {
+            json envelope = json::parse(reply);
+            return envelope["candidates"][0]["content"]["parts"][0]["text"].get_ref<const std::string &>().size(); });
+
+        std::string full_text;
+        ExtractCandidateText(reply, full_text);
+        std::string short_text;
+        ExtractCandidateText(short_reply, short_text);
+        Run(options, "result/parse-persian-only", short_text.size(), [&]
+            { return TranslationResult::Parse(short_text).persian_definition.size(); });
+        Run(options, "result/parse-full", full_text.size(), [&]
+            { return TranslationResult::Parse(full_text).persian_definition.size(); });
+
+        const TranslationResult result = TranslationResult::Parse(full_text);
+        Run(options, "result/serialize", 0, [&]
+            { return result.Serialize().size(); });
+    }
+
+    // Whole lookups through Translator against the mock server: transport,
+    // parsing and caching together. Every input is distinct, so each one
+    // is a cache miss and a request.
+    void RunMockServerBenchmarks(const Options &options)
+    {
+        const size_t levels[] = {1, 4, 16, 64};
+        for (size_t level : levels)
+        {
+            const std::string name = "mock/concurrency-" + std::to_string(level);
+            if (name.find(options.filter) == std::string::npos)
+                continue;
+
+            MockServer mock(std::chrono::milliseconds(options.mock_latency_ms));
+            std::string model_text;
+            ExtractCandidateText(kFullDictionaryReply, model_text);
+            mock.AddResponse(model_text);
+            if (!mock.Start())
+            {
+                std::cerr << "Failed to start the mock server." << std::endl;
+                return;
+            }
+            Translator translator;
+            translator.setBackend(std::make_shared<MockBackend>(mock.Port()));
+
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> failures{0};
+            const AllocationCount before;
+            const auto started = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < level; ++t)
+            {
+                threads.emplace_back([&]
+                                     {
+                    std::string input;
+                    for (size_t i = next++; i < options.requests; i = next++)
+                    {
+                        input = "benchmark input " + std::to_string(level) + "-" + std::to_string(i);
+                        try
+                        {
+                            translator.Translate(input, RequestClass::Bulk);
+                        }
+                        catch (const std::exception &)
+                        {
+                            ++failures;
+                        }
+                    } });
+            }
+            for (std::thread &thread : threads)
+                thread.join();
+            const auto elapsed = std::chrono::steady_clock::now() - started;
+            const AllocationCount after;
+
+            const double seconds = std::chrono::duration<double>(elapsed).count();
+            const Metrics &metrics = translator.GetMetrics();
+            const double requests = static_cast<double>(options.requests);
+            char line[320];
+            std::snprintf(line, sizeof(line), "%-34s %9.0f req/s %8.1f allocs/req %10.1f B/req  p50 %llu us  p99 %llu us  %llu connections  %zu failed",
+                          name.c_str(), requests / seconds,
+                          static_cast<double>(after.allocations - before.allocations) / requests,
+                          static_cast<double>(after.bytes - before.bytes) / requests,
+                          static_cast<unsigned long long>(metrics.total.Percentile(0.5)),
+                          static_cast<unsigned long long>(metrics.total.Percentile(0.99)),
+                          static_cast<unsigned long long>(metrics.new_connections.load()),
+                          failures.load());
+            std::cout << line << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    RunMicroBenchmarks(options);
+    RunMockServerBenchmarks(options);
+    return 0;
+}
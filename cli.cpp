@@ -0,0 +1,344 @@
+// Headless entry point: translates newline-delimited input from stdin or a
+// file and writes one JSON object per line to stdout as lookups finish.
+//
+// Usage: translatur-cli [--input FILE] [--config FILE] [--jobs N] [--unordered] [--mock-latency MS] [--metrics FILE] [--verbose]
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <MockServer.hpp>
+#include <Rest.hpp>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace
+{
+    struct Options
+    {
+        std::string input_path;
+        std::string config_path = "config.json";
+        size_t jobs = 4;
+        bool ordered = true;
+        int mock_latency_ms = -1;
+        std::string metrics_path;
+        bool verbose = false;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "Usage: translatur-cli [--input FILE] [--config FILE] [--jobs N] [--unordered] [--mock-latency MS] [--metrics FILE] [--verbose]\n"
+                     "Reads one word or sentence per line (stdin by default) and writes JSON Lines to stdout.\n"
+                     "--mock-latency answers every lookup from a local mock server after MS milliseconds.\n"
+                     "--metrics writes request timings to FILE when done: JSON if it ends in .json, Prometheus text otherwise.\n"
+                     "--verbose reports retries, hedged requests and batch fallbacks on stderr.\n";
+    }
+
+    bool ParseOptions(int argc, char **argv, Options &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--input" && i + 1 < argc)
+                options.input_path = argv[++i];
+            else if (arg == "--config" && i + 1 < argc)
+                options.config_path = argv[++i];
+            else if (arg == "--jobs" && i + 1 < argc)
+                options.jobs = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--unordered")
+                options.ordered = false;
+            else if (arg == "--mock-latency" && i + 1 < argc)
+                options.mock_latency_ms = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "--metrics" && i + 1 < argc)
+                options.metrics_path = argv[++i];
+            else if (arg == "--verbose")
+                options.verbose = true;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    // With `mock` set, lookups go to the mock server: no API key is needed,
+    // and the disk cache stays off so mock answers never reach the real
+    // translations.cache.
+    bool ConfigureTranslator(const std::string &path, bool mock, Translator &translator)
+    {
+        json config;
+        std::ifstream in(path);
+        if (in.is_open())
+        {
+            try
+            {
+                in >> config;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Failed to parse " << path << ": " << e.what() << std::endl;
+                return false;
+            }
+        }
+
+        if (config.contains("api_key") && config["api_key"].is_string())
+            translator.setApiKey(config["api_key"].get<std::string>());
+        if (config.contains("api_keys") && config["api_keys"].is_array())
+        {
+            std::vector<std::string> keys;
+            for (const json &key : config["api_keys"])
+            {
+                if (key.is_string())
+                    keys.push_back(key.get<std::string>());
+            }
+            if (!keys.empty())
+                translator.setApiKeys(keys);
+        }
+        if (!mock && translator.getApiKey().empty())
+        {
+            std::cerr << "API key not found in " << path << "." << std::endl;
+            return false;
+        }
+
+        if (config.contains("model") && config["model"].is_string())
+            translator.setBackend(std::make_shared<GeminiBackend>(config["model"].get<std::string>()));
+        if (config.contains("bulk_model") && config["bulk_model"].is_string())
+            translator.setBackend(std::make_shared<GeminiBackend>(config["bulk_model"].get<std::string>()), RequestClass::Bulk);
+        PromptProfile profile;
+        if (config.contains("prompt_profile") && config["prompt_profile"].is_string() &&
+            ParsePromptProfile(config["prompt_profile"].get<std::string>(), profile))
+            translator.setPromptProfile(profile);
+        if (config.contains("bulk_prompt_profile") && config["bulk_prompt_profile"].is_string() &&
+            ParsePromptProfile(config["bulk_prompt_profile"].get<std::string>(), profile))
+            translator.setPromptProfile(profile, RequestClass::Bulk);
+
+        // The GUI saves the port as a string; a hand-written config may well
+        // use a number.
+        if (config.contains("proxy_ip") && config["proxy_ip"].is_string() && config.contains("proxy_port"))
+        {
+            const json &port = config["proxy_port"];
+            if (port.is_string())
+                translator.setProxy(config["proxy_ip"].get<std::string>(), port.get<std::string>());
+            else if (port.is_number_unsigned())
+                translator.setProxy(config["proxy_ip"].get<std::string>(), std::to_string(port.get<unsigned>()));
+        }
+
+        uint64_t cacheMaxBytes = 8 * 1024 * 1024;
+        if (config.contains("cache_max_bytes") && config["cache_max_bytes"].is_number_unsigned())
+            cacheMaxBytes = config["cache_max_bytes"].get<uint64_t>();
+        if (!mock)
+            translator.EnableDiskCache("translations.cache", cacheMaxBytes);
+
+        if (config.contains("memory_cache_bytes") && config["memory_cache_bytes"].is_number_unsigned())
+            translator.setMemoryCacheLimit(config["memory_cache_bytes"].get<size_t>());
+        if (config.contains("connect_timeout_ms") && config["connect_timeout_ms"].is_number_unsigned())
+            translator.setConnectTimeout(std::chrono::milliseconds(config["connect_timeout_ms"].get<long>()));
+        if (config.contains("timeout_ms") && config["timeout_ms"].is_number_unsigned())
+            translator.setTotalTimeout(std::chrono::milliseconds(config["timeout_ms"].get<long>()));
+        if (config.contains("max_attempts") && config["max_attempts"].is_number_integer())
+            translator.setMaxAttempts(config["max_attempts"].get<int>());
+        if (config.contains("hedge_requests") && config["hedge_requests"].is_boolean())
+            translator.setHedging(config["hedge_requests"].get<bool>());
+        if ((config.contains("requests_per_minute") && config["requests_per_minute"].is_number()) ||
+            (config.contains("tokens_per_minute") && config["tokens_per_minute"].is_number()))
+            translator.setRateLimits(config.value("requests_per_minute", 0.0), config.value("tokens_per_minute", 0.0));
+        return true;
+    }
+
+    // Hands out runs of input lines to the workers and writes finished
+    // results, either as they complete or in input order through a bounded
+    // reorder window so a slow lookup cannot make the buffer grow without
+    // limit.
+    class Pipeline
+    {
+    public:
+        Pipeline(std::istream &in, bool ordered, size_t window)
+            : in(in), ordered(ordered), window(window) {}
+
+        // Fills `lines` with up to `max_items` consecutive lines of at most
+        // `max_chars` in total (a longer line comes alone), numbered from
+        // `first_index`. Returns false at the end of the input.
+        bool Next(size_t max_items, size_t max_chars, size_t &first_index, std::vector<std::string> &lines)
+        {
+            lines.clear();
+            std::unique_lock<std::mutex> lock(mutex);
+            if (ordered)
+                cv.wait(lock, [this]
+                        { return next_index - next_emit < window; });
+            first_index = next_index;
+            size_t chars = 0;
+            std::string line;
+            while (lines.size() < max_items && (!ordered || next_index - next_emit < window) && ReadLine(line))
+            {
+                if (!lines.empty() && chars + line.size() > max_chars)
+                {
+                    held = std::move(line);
+                    has_held = true;
+                    break;
+                }
+                chars += line.size();
+                lines.push_back(std::move(line));
+                ++next_index;
+            }
+            return !lines.empty();
+        }
+
+        void Emit(size_t index, std::string record)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ordered)
+            {
+                std::cout << record << '\n'
+                          << std::flush;
+                return;
+            }
+            pending.emplace(index, std::move(record));
+            for (auto it = pending.find(next_emit); it != pending.end(); it = pending.find(next_emit))
+            {
+                std::cout << it->second << '\n';
+                pending.erase(it);
+                ++next_emit;
+            }
+            std::cout << std::flush;
+            cv.notify_all();
+        }
+
+    private:
+        // The next non-empty line; called with the mutex held.
+        bool ReadLine(std::string &line)
+        {
+            if (has_held)
+            {
+                line = std::move(held);
+                has_held = false;
+                return true;
+            }
+            while (std::getline(in, line))
+            {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (!line.empty())
+                    return true;
+            }
+            return false;
+        }
+
+        std::istream &in;
+        bool ordered;
+        size_t window;
+        // A line read past the end of the last batch, for the next one.
+        std::string held;
+        bool has_held = false;
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t next_index = 0;
+        size_t next_emit = 0;
+        std::map<size_t, std::string> pending;
+    };
+
+    std::string MakeRecord(size_t index, const std::string &input, const TranslationResult &result, const std::string &error)
+    {
+        json record = {{"index", index}, {"input", input}};
+        if (!error.empty())
+            record["error"] = error;
+        else
+            record["result"] = result.ToJson();
+        return record.dump(-1, ' ', false, json::error_handler_t::replace);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    std::ifstream file;
+    if (!options.input_path.empty())
+    {
+        file.open(options.input_path);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open " << options.input_path << std::endl;
+            return 1;
+        }
+    }
+    std::istream &in = options.input_path.empty() ? std::cin : file;
+
+    Translator translator;
+    if (options.verbose)
+    {
+        translator.setLogCallback([](const std::string &message)
+                                  {
+            static std::mutex mutex;
+            std::lock_guard<std::mutex> lock(mutex);
+            std::cerr << message << std::endl; });
+    }
+    if (!ConfigureTranslator(options.config_path, options.mock_latency_ms >= 0, translator))
+        return 1;
+
+    MockServer mock(std::chrono::milliseconds(std::max(0, options.mock_latency_ms)));
+    if (options.mock_latency_ms >= 0)
+    {
+        if (!mock.Start())
+        {
+            std::cerr << "Failed to start the mock server." << std::endl;
+            return 1;
+        }
+        translator.setBackend(std::make_shared<MockBackend>(mock.Port()));
+    }
+
+    // Each worker takes a batch's worth of lines at a time, so uncached
+    // lines go to the API as few multi-input requests.
+    Pipeline pipeline(in, options.ordered, options.jobs * Translator::kBatchMaxItems * 2);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < options.jobs; ++i)
+    {
+        workers.emplace_back([&translator, &pipeline]
+                             {
+            size_t first_index;
+            std::vector<std::string> lines;
+            while (pipeline.Next(Translator::kBatchMaxItems, Translator::kBatchMaxInputChars, first_index, lines))
+            {
+                std::vector<std::optional<TranslationResult>> results;
+                std::string error = "Translation failed";
+                try
+                {
+                    results = translator.TranslateBatch(lines);
+                }
+                catch (const std::exception &e)
+                {
+                    error = e.what();
+                }
+                results.resize(lines.size());
+                for (size_t j = 0; j < lines.size(); ++j)
+                {
+                    const size_t index = first_index + j;
+                    pipeline.Emit(index, results[j] ? MakeRecord(index, lines[j], *results[j], std::string())
+                                                    : MakeRecord(index, lines[j], TranslationResult(), error));
+                }
+            } });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+
+    const RateLimiter::Stats scheduler = translator.GetSchedulerStats();
+    if (scheduler.throttled > 0)
+        std::cerr << scheduler.throttled << " requests waited for the rate limit." << std::endl;
+    if (!options.metrics_path.empty() && !translator.GetMetrics().WriteFile(options.metrics_path))
+    {
+        std::cerr << "Failed to write " << options.metrics_path << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Builds an offline dictionary file for the GUI from a word list.
+//
+// Usage: translatur-dictimport INPUT OUTPUT
+//
+// INPUT is either tab-separated text, one "word<TAB>Persian" pair per line
+// (blank lines and lines starting with '#' are skipped), or, if it ends in
+// .json, an object mapping words to Persian or an array of objects with
+// "word" and "persian_definition" fields.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <OfflineDictionary.hpp>
+#include <TextNormalize.hpp>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace
+{
+    using WordList = std::vector<std::pair<std::string, std::string>>;
+
+    void Add(WordList &words, const std::string &word, const std::string &persian)
+    {
+        std::string key = NormalizeKey(word);
+        if (!key.empty() && !persian.empty())
+            words.emplace_back(std::move(key), persian);
+    }
+
+    bool ReadTsv(std::istream &in, WordList &words)
+    {
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty() || line[0] == '#')
+                continue;
+            const size_t tab = line.find('\t');
+            if (tab == std::string::npos)
+                continue;
+            const size_t end = line.find('\t', tab + 1);
+            Add(words, line.substr(0, tab), line.substr(tab + 1, end == std::string::npos ? std::string::npos : end - tab - 1));
+        }
+        return true;
+    }
+
+    bool ReadJson(std::istream &in, WordList &words)
+    {
+        json j = json::parse(in, nullptr, false);
+        if (j.is_object())
+        {
+            for (auto it = j.begin(); it != j.end(); ++it)
+            {
+                if (it.value().is_string())
+                    Add(words, it.key(), it.value().get<std::string>());
+            }
+            return true;
+        }
+        if (j.is_array())
+        {
+            for (const json &item : j)
+            {
+                if (item.is_object() && item.contains("word") && item["word"].is_string() &&
+                    item.contains("persian_definition") && item["persian_definition"].is_string())
+                    Add(words, item["word"].get<std::string>(), item["persian_definition"].get<std::string>());
+            }
+            return true;
+        }
+        return false;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: translatur-dictimport INPUT OUTPUT\n"
+                     "INPUT is word<TAB>Persian lines, or a .json object/array of words.\n";
+        return 2;
+    }
+    const std::string input_path = argv[1];
+    const std::string output_path = argv[2];
+
+    std::ifstream in(input_path, std::ios::binary);
+    if (!in.is_open())
+    {
+        std::cerr << "Failed to open " << input_path << std::endl;
+        return 1;
+    }
+    WordList words;
+    const bool is_json = input_path.size() >= 5 && input_path.compare(input_path.size() - 5, 5, ".json") == 0;
+    if (!(is_json ? ReadJson(in, words) : ReadTsv(in, words)))
+    {
+        std::cerr << "Failed to parse " << input_path << std::endl;
+        return 1;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const size_t read = words.size();
+    if (!OfflineDictionary::Build(std::move(words), output_path))
+    {
+        std::cerr << "Failed to write " << output_path << std::endl;
+        return 1;
+    }
+    OfflineDictionary dictionary;
+    if (!dictionary.Open(output_path))
+    {
+        std::cerr << "Failed to reopen " << output_path << std::endl;
+        return 1;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    std::cerr << "Wrote " << dictionary.Size() << " entries (" << read << " read) to " << output_path
+              << " in " << elapsed.count() << " ms." << std::endl;
+    return 0;
+}
@@ -6,14 +6,20 @@
 #include <wx/stattext.h>
 #include <wx/sizer.h>
 #include <wx/button.h>
+#include <wx/listbox.h>
 #include <wx/log.h>
 #include <wx/settings.h>
 
 #include <fstream>
 #include <algorithm>
 #include <cctype>
+#include <thread>
 
+#include <ClipboardWatcher.hpp>
+#include <OfflineDictionary.hpp>
 #include <Rest.hpp>
+#include <SuggestionIndex.hpp>
+#include <TextNormalize.hpp>
 #include <json.hpp>
 
 using json = nlohmann::json;
@@ -40,6 +46,18 @@ public:
 
 private:
     void OnTranslate(wxCommandEvent &event);
+    std::string GetInputWord() const;
+    bool ShowOfflineTranslation(const std::string &word);
+    void StartTranslation(const std::string &word);
+    void OnInputChanged(wxCommandEvent &event);
+    void AbandonStaleLookup();
+    void UpdateSuggestions();
+    void OnSuggestionSelected(wxCommandEvent &event);
+    void OnTranslationDone(unsigned serial, const std::string &word, const TranslationResult &result, const std::string &error);
+    void OnTranslationPartial(unsigned serial, const std::string &persian_definition);
+    void OnStreamToggle(wxCommandEvent &event);
+    void OnPrefetchToggle(wxCommandEvent &event);
+    void OnClipboardWatchToggle(wxCommandEvent &event);
     void ShowAndFocus();
     void OnHotkey(wxKeyEvent &event);
     void OnActivate(wxActivateEvent &event);
@@ -48,17 +66,29 @@ private:
     void OnThemeSelect(wxCommandEvent &event);
     void ApplyTheme(Theme theme);
     void OnProxy(wxCommandEvent &event);
+    void OnDiagnostics(wxCommandEvent &event);
     void LoadConfig();
     void SaveConfig();
 
     wxTextCtrl *m_inputCtrl = nullptr;
+    wxListBox *m_suggestionList = nullptr;
     wxTextCtrl *m_outputCtrl = nullptr;
     wxButton *m_translateBtn = nullptr;
     wxPanel *m_panel = nullptr;
 
     Translator m_Translator;
+    ClipboardWatcher m_clipboardWatcher{m_Translator};
+    OfflineDictionary m_dictionary;
+    SuggestionIndex m_suggestions;
+    std::vector<SuggestionIndex::Suggestion> m_shownSuggestions;
+    std::thread m_historyLoader;
+    std::shared_ptr<TranslationRequest> m_pendingRequest;
+    std::string m_pendingWord;
+    unsigned m_requestSerial = 0;
     json m_config;
     Theme m_currentTheme = Theme::Light;
+    bool m_streaming = false;
+    bool m_prefetch = false;
 
     wxDECLARE_EVENT_TABLE();
 };
@@ -71,7 +101,11 @@ enum
     ID_Menu_Shortcut,
     ID_Proxy,
     ID_Theme_Light,
-    ID_Theme_Dark
+    ID_Theme_Dark,
+    ID_Stream,
+    ID_Prefetch,
+    ID_ClipboardWatch,
+    ID_Diagnostics
 };
 
 wxBEGIN_EVENT_TABLE(MyFrame, wxFrame)
@@ -96,10 +130,15 @@ MyFrame::MyFrame()
     optionsMenu->Append(ID_Append_API, "API KEY...\tCtrl+Shift+A", "Enter your API KEY");
     optionsMenu->Append(ID_Menu_Shortcut, "Shortcut...\tCtrl+Shift+S", "Change the global shortcut");
     optionsMenu->Append(ID_Proxy, "Proxy...\tCtrl+Shift+D", "Set Proxy");
+    optionsMenu->AppendCheckItem(ID_Stream, "Stream Results", "Show the translation while it is being generated");
+    optionsMenu->AppendCheckItem(ID_Prefetch, "Translate on Hotkey", "Start translating the clipboard as soon as the hotkey is pressed");
+    optionsMenu->AppendCheckItem(ID_ClipboardWatch, "Watch Clipboard", "Pre-translate copied text in the background");
     optionsMenu->AppendSeparator();
 
     optionsMenu->AppendRadioItem(ID_Theme_Light, "Light Theme", "Use the light theme");
     optionsMenu->AppendRadioItem(ID_Theme_Dark, "Dark Theme", "Use the dark theme");
+    optionsMenu->AppendSeparator();
+    optionsMenu->Append(ID_Diagnostics, "Diagnostics...", "Show request timings and cache statistics");
 
     menuBar->Append(optionsMenu, "&Options");
 
@@ -108,11 +147,14 @@ MyFrame::MyFrame()
     m_panel = new wxPanel(this);
 
     m_inputCtrl = new wxTextCtrl(m_panel, wxID_ANY, "", wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
+    m_suggestionList = new wxListBox(m_panel, wxID_ANY);
+    m_suggestionList->Hide();
     m_translateBtn = new wxButton(m_panel, ID_Translate, "Translate");
     m_outputCtrl = new wxTextCtrl(m_panel, wxID_ANY, "", wxDefaultPosition, wxDefaultSize, wxTE_MULTILINE | wxTE_READONLY | wxTE_RIGHT);
 
     wxBoxSizer *vbox = new wxBoxSizer(wxVERTICAL);
     vbox->Add(m_inputCtrl, 0, wxEXPAND | wxALL, 5);
+    vbox->Add(m_suggestionList, 0, wxEXPAND | wxLEFT | wxRIGHT, 5);
     vbox->Add(m_translateBtn, 0, wxEXPAND | wxALL, 5);
     vbox->Add(m_outputCtrl, 1, wxEXPAND | wxALL, 5);
 
@@ -131,17 +173,48 @@ MyFrame::MyFrame()
     Bind(wxEVT_TEXT_ENTER, &MyFrame::OnTranslate, this, m_inputCtrl->GetId());
     Bind(wxEVT_ACTIVATE, &MyFrame::OnActivate, this);
     Bind(wxEVT_MENU,&MyFrame::OnProxy,this,ID_Proxy);
+    Bind(wxEVT_MENU, &MyFrame::OnStreamToggle, this, ID_Stream);
+    Bind(wxEVT_MENU, &MyFrame::OnPrefetchToggle, this, ID_Prefetch);
+    Bind(wxEVT_MENU, &MyFrame::OnClipboardWatchToggle, this, ID_ClipboardWatch);
+    Bind(wxEVT_MENU, &MyFrame::OnDiagnostics, this, ID_Diagnostics);
+    Bind(wxEVT_TEXT, &MyFrame::OnInputChanged, this, m_inputCtrl->GetId());
+    Bind(wxEVT_LISTBOX, &MyFrame::OnSuggestionSelected, this, m_suggestionList->GetId());
 
     m_translateBtn->SetDefault();
 
     LoadConfig();
 
+    // Earlier translations feed the as-you-type suggestions; reading the
+    // disk cache can take a moment, so it happens off the UI thread.
+    m_historyLoader = std::thread([this]
+                                  {
+        std::vector<std::pair<std::string, std::string>> history;
+        m_Translator.ForEachCached([&history](const std::string &word, const TranslationResult &result)
+                                   { history.emplace_back(word, result.persian_definition); });
+        m_suggestions.AddAll(std::move(history)); });
+
     ApplyTheme(m_currentTheme);
 }
 
 MyFrame::~MyFrame()
 {
+    if (m_historyLoader.joinable())
+        m_historyLoader.join();
+    m_clipboardWatcher.Stop();
+    if (m_pendingRequest)
+        m_pendingRequest->Cancel();
     UnregisterHotKey(ID_Hotkey);
+
+    DiskCache::Stats stats = m_Translator.GetDiskCacheStats();
+    wxLogVerbose("Translation cache: %llu hits, %llu misses, %llu entries.",
+                 (unsigned long long)stats.hits, (unsigned long long)stats.misses, (unsigned long long)stats.entries);
+
+    if (m_config.contains("metrics_file") && m_config["metrics_file"].is_string())
+    {
+        const std::string metricsFile = m_config["metrics_file"].get<std::string>();
+        if (!m_Translator.GetMetrics().WriteFile(metricsFile))
+            wxLogError("Failed to write metrics to %s.", metricsFile);
+    }
 }
 
 void MyFrame::LoadConfig()
@@ -169,7 +242,21 @@ void MyFrame::LoadConfig()
         wxLogVerbose("config.json not found or could not be opened. Starting with default settings.");
     }
 
-    if (m_config.contains("api_key") && m_config["api_key"].is_string())
+    std::vector<std::string> apiKeys;
+    if (m_config.contains("api_keys") && m_config["api_keys"].is_array())
+    {
+        for (const json &key : m_config["api_keys"])
+        {
+            if (key.is_string())
+                apiKeys.push_back(key.get<std::string>());
+        }
+    }
+    if (!apiKeys.empty())
+    {
+        m_Translator.setApiKeys(apiKeys);
+        wxLogVerbose("%zu API keys loaded from config.", apiKeys.size());
+    }
+    else if (m_config.contains("api_key") && m_config["api_key"].is_string())
     {
         m_Translator.setApiKey(m_config["api_key"].get<std::string>());
         wxLogVerbose("API key loaded from config.");
@@ -186,6 +273,65 @@ void MyFrame::LoadConfig()
     {
         m_Translator.setProxy(m_config["proxy_ip"].get<std::string>(), m_config["proxy_port"].get<std::string>());
     }
+
+    if (m_config.contains("model") && m_config["model"].is_string())
+    {
+        m_Translator.setBackend(std::make_shared<GeminiBackend>(m_config["model"].get<std::string>()));
+    }
+    if (m_config.contains("bulk_model") && m_config["bulk_model"].is_string())
+    {
+        m_Translator.setBackend(std::make_shared<GeminiBackend>(m_config["bulk_model"].get<std::string>()), RequestClass::Bulk);
+    }
+    PromptProfile profile;
+    if (m_config.contains("prompt_profile") && m_config["prompt_profile"].is_string())
+    {
+        if (ParsePromptProfile(m_config["prompt_profile"].get<std::string>(), profile))
+            m_Translator.setPromptProfile(profile);
+        else
+            wxLogWarning("Unknown prompt_profile in config.json; expected persian-only, full-dictionary or sentence.");
+    }
+    if (m_config.contains("bulk_prompt_profile") && m_config["bulk_prompt_profile"].is_string())
+    {
+        if (ParsePromptProfile(m_config["bulk_prompt_profile"].get<std::string>(), profile))
+            m_Translator.setPromptProfile(profile, RequestClass::Bulk);
+        else
+            wxLogWarning("Unknown bulk_prompt_profile in config.json; expected persian-only, full-dictionary or sentence.");
+    }
+
+    uint64_t cacheMaxBytes = 8 * 1024 * 1024;
+    if (m_config.contains("cache_max_bytes") && m_config["cache_max_bytes"].is_number_unsigned())
+    {
+        cacheMaxBytes = m_config["cache_max_bytes"].get<uint64_t>();
+    }
+    m_Translator.EnableDiskCache("translations.cache", cacheMaxBytes);
+
+    if (m_config.contains("memory_cache_bytes") && m_config["memory_cache_bytes"].is_number_unsigned())
+    {
+        m_Translator.setMemoryCacheLimit(m_config["memory_cache_bytes"].get<size_t>());
+    }
+    if (m_config.contains("connect_timeout_ms") && m_config["connect_timeout_ms"].is_number_unsigned())
+    {
+        m_Translator.setConnectTimeout(std::chrono::milliseconds(m_config["connect_timeout_ms"].get<long>()));
+    }
+    if (m_config.contains("timeout_ms") && m_config["timeout_ms"].is_number_unsigned())
+    {
+        m_Translator.setTotalTimeout(std::chrono::milliseconds(m_config["timeout_ms"].get<long>()));
+    }
+    if (m_config.contains("max_attempts") && m_config["max_attempts"].is_number_integer())
+    {
+        m_Translator.setMaxAttempts(m_config["max_attempts"].get<int>());
+    }
+    if (m_config.contains("hedge_requests") && m_config["hedge_requests"].is_boolean())
+    {
+        m_Translator.setHedging(m_config["hedge_requests"].get<bool>());
+    }
+    m_Translator.setLogCallback([](const std::string &message)
+                                { wxLogVerbose("%s", wxString::FromUTF8(message)); });
+    if ((m_config.contains("requests_per_minute") && m_config["requests_per_minute"].is_number()) ||
+        (m_config.contains("tokens_per_minute") && m_config["tokens_per_minute"].is_number()))
+    {
+        m_Translator.setRateLimits(m_config.value("requests_per_minute", 0.0), m_config.value("tokens_per_minute", 0.0));
+    }
     if (m_config.contains("shortcut") && m_config["shortcut"].is_object())
     {
         try
@@ -264,9 +410,61 @@ void MyFrame::LoadConfig()
         wxLogVerbose("Theme not found in config. Using default Light theme.");
     }
 
+    if (m_config.contains("streaming") && m_config["streaming"].is_boolean())
+    {
+        m_streaming = m_config["streaming"].get<bool>();
+    }
+
+    if (m_config.contains("prefetch_on_hotkey") && m_config["prefetch_on_hotkey"].is_boolean())
+    {
+        m_prefetch = m_config["prefetch_on_hotkey"].get<bool>();
+    }
+
+    if (m_config.contains("clipboard_max_length") && m_config["clipboard_max_length"].is_number_unsigned())
+    {
+        m_clipboardWatcher.setMaxLength(m_config["clipboard_max_length"].get<size_t>());
+    }
+    if (m_config.contains("clipboard_max_per_minute") && m_config["clipboard_max_per_minute"].is_number_unsigned())
+    {
+        m_clipboardWatcher.setMaxPerMinute(m_config["clipboard_max_per_minute"].get<size_t>());
+    }
+    if (m_config.contains("clipboard_watch") && m_config["clipboard_watch"].is_boolean() && m_config["clipboard_watch"].get<bool>())
+    {
+        m_clipboardWatcher.Start();
+    }
+
+    std::string dictionaryPath = "dictionary.trd";
+    if (m_config.contains("dictionary") && m_config["dictionary"].is_string())
+    {
+        dictionaryPath = m_config["dictionary"].get<std::string>();
+    }
+    if (m_dictionary.Open(dictionaryPath))
+    {
+        wxLogVerbose("Offline dictionary loaded: %zu entries.", m_dictionary.Size());
+    }
+    m_clipboardWatcher.setOfflineDictionary(&m_dictionary);
+
     wxMenuBar *menuBar = GetMenuBar();
     if (menuBar)
     {
+        wxMenuItem *streamItem = menuBar->FindItem(ID_Stream);
+        if (streamItem)
+        {
+            streamItem->Check(m_streaming);
+        }
+
+        wxMenuItem *prefetchItem = menuBar->FindItem(ID_Prefetch);
+        if (prefetchItem)
+        {
+            prefetchItem->Check(m_prefetch);
+        }
+
+        wxMenuItem *watchItem = menuBar->FindItem(ID_ClipboardWatch);
+        if (watchItem)
+        {
+            watchItem->Check(m_clipboardWatcher.IsRunning());
+        }
+
         wxMenuItem *lightItem = menuBar->FindItem(ID_Theme_Light);
         wxMenuItem *darkItem = menuBar->FindItem(ID_Theme_Dark);
         if (lightItem && darkItem)
@@ -332,6 +530,12 @@ void MyFrame::ApplyTheme(Theme theme)
         m_inputCtrl->SetOwnForegroundColour(textCtrlTextColor);
     }
 
+    if (m_suggestionList)
+    {
+        m_suggestionList->SetBackgroundColour(textCtrlBgColor);
+        m_suggestionList->SetForegroundColour(textCtrlTextColor);
+    }
+
     if (m_outputCtrl)
     {
         m_outputCtrl->SetBackgroundColour(textCtrlBgColor);
@@ -382,6 +586,7 @@ void MyFrame::OnThemeSelect(wxCommandEvent &event)
 
 void MyFrame::ShowAndFocus()
 {
+    bool pasted = false;
     wxClipboardLocker lock;
     {
         if (wxTheClipboard->IsSupported(wxDF_TEXT))
@@ -389,8 +594,12 @@ void MyFrame::ShowAndFocus()
             wxTextDataObject data;
             if (wxTheClipboard->GetData(data))
             {
-                m_inputCtrl->SetValue(data.GetText());
+                // ChangeValue does not emit wxEVT_TEXT, which would cancel the
+                // prefetch below, so drop a lookup for the replaced text here.
+                m_inputCtrl->ChangeValue(data.GetText());
                 m_inputCtrl->SetInsertionPointEnd();
+                AbandonStaleLookup();
+                pasted = true;
                 wxLogVerbose("Pasted text from clipboard.");
             }
             else
@@ -404,6 +613,20 @@ void MyFrame::ShowAndFocus()
         }
     }
 
+    // Start the lookup while the window is still appearing; the result is
+    // shown as soon as it arrives, or instantly if it is already cached.
+    if (m_prefetch && pasted)
+    {
+        std::string word = GetInputWord();
+        // Dictionary hits are shown right away and need no request.
+        if (!word.empty() && !ShowOfflineTranslation(word) && !m_Translator.getApiKey().empty() &&
+            !(m_pendingRequest && m_pendingWord == word))
+        {
+            StartTranslation(word);
+            wxLogVerbose("Prefetching translation for clipboard text.");
+        }
+    }
+
     Show(true);
     Raise();
     m_inputCtrl->SetFocus();
@@ -451,14 +674,11 @@ void MyFrame::OnTranslate(wxCommandEvent &event)
         return;
     }
 
-    std::string response;
-    std::string translate_word = word.ToStdString();
+    std::string translate_word = GetInputWord();
 
-    translate_word.erase(
-        std::remove_if(translate_word.begin(), translate_word.end(),
-                       [](unsigned char c)
-                       { return c < 32 || c > 126; }),
-        translate_word.end());
+    // Dictionary hits need neither the network nor an API key.
+    if (ShowOfflineTranslation(translate_word))
+        return;
 
     if (m_Translator.getApiKey().empty())
     {
@@ -466,47 +686,203 @@ void MyFrame::OnTranslate(wxCommandEvent &event)
         return;
     }
 
-    try
+    if (m_pendingRequest && m_pendingWord == translate_word)
     {
-        response = m_Translator.Translate(translate_word);
-        wxLogVerbose("Translation API call successful for word: '%s'", translate_word);
-    }
-    catch (const std::exception &e)
-    {
-        m_outputCtrl->SetValue(wxString::Format("Translation API call failed: %s", e.what()));
-        wxLogError("Translation API call failed: %s", e.what());
+        wxLogVerbose("Translation for '%s' is already in flight.", translate_word);
         return;
     }
 
-    try
+    StartTranslation(translate_word);
+}
+
+std::string MyFrame::GetInputWord() const
+{
+    const wxScopedCharBuffer utf8 = m_inputCtrl->GetValue().ToUTF8();
+    return SanitizeInput(std::string(utf8.data(), utf8.length()));
+}
+
+bool MyFrame::ShowOfflineTranslation(const std::string &word)
+{
+    // Sentences go to the model; the dictionary only holds words and short terms.
+    const std::string key = NormalizeKey(word);
+    if (!m_dictionary.IsOpen() || key.empty() || std::count(key.begin(), key.end(), ' ') >= 3)
+        return false;
+
+    std::string persian;
+    if (!m_dictionary.Lookup(key, persian))
+        return false;
+
+    if (m_pendingRequest)
+        m_pendingRequest->Cancel();
+    m_pendingRequest.reset();
+    m_pendingWord.clear();
+    ++m_requestSerial; // Drop results of anything still in flight.
+    m_outputCtrl->SetValue(wxString::FromUTF8(persian.c_str()));
+    wxLogVerbose("Translated '%s' from the offline dictionary.", word);
+    return true;
+}
+
+void MyFrame::StartTranslation(const std::string &translate_word)
+{
+    if (m_pendingRequest)
+        m_pendingRequest->Cancel();
+
+    m_outputCtrl->SetValue("Translating...");
+    m_pendingWord = translate_word;
+    const unsigned serial = ++m_requestSerial;
+    TranslateCallback done = [this, serial, translate_word](const TranslationResult &result, const std::string &error)
     {
-        json j = json::parse(response);
-        wxLogVerbose("API response parsed successfully.");
+        CallAfter([this, serial, translate_word, result, error]
+                  { OnTranslationDone(serial, translate_word, result, error); });
+    };
 
-        std::string persian_translation = j.value("persian_definition", "Translation definition not found in response.");
+    PartialCallback partial = [this, serial](const std::string &persian_definition)
+    {
+        CallAfter([this, serial, persian_definition]
+                  { OnTranslationPartial(serial, persian_definition); });
+    };
+
+    // Pasted paragraphs are split into sentences and translated in
+    // parallel; the output fills in from the top as parts finish.
+    const size_t kDocumentModeChars = 300;
+    if (CountCharacters(translate_word) > kDocumentModeChars)
+    {
+        m_pendingRequest = m_Translator.TranslateDocumentAsync(translate_word, partial, done);
+    }
+    else if (m_streaming)
+    {
+        m_pendingRequest = m_Translator.TranslateStreamAsync(translate_word, partial, done);
+    }
+    else
+    {
+        m_pendingRequest = m_Translator.TranslateAsync(translate_word, done);
+    }
+}
 
-        wxString rtlText = wxString::FromUTF8(persian_translation.c_str());
+void MyFrame::OnTranslationDone(unsigned serial, const std::string &word, const TranslationResult &result, const std::string &error)
+{
+    if (serial != m_requestSerial)
+        return; // A newer lookup replaced this one.
+    m_pendingRequest.reset();
+    m_pendingWord.clear();
 
-        m_outputCtrl->SetValue(rtlText);
-        wxLogVerbose("Displayed translation result.");
+    // A document with a failed part still carries the parts that worked.
+    if (!error.empty() && result.persian_definition.empty())
+    {
+        m_outputCtrl->SetValue(wxString::Format("Translation API call failed: %s", error.c_str()));
+        wxLogError("Translation API call failed: %s", error.c_str());
+        return;
     }
-    catch (const json::parse_error &e)
+    if (!error.empty())
+        wxLogWarning("Part of the text was left untranslated: %s", error.c_str());
+    wxLogVerbose("Translation API call successful for word: '%s'", word);
+
+    if (result.persian_definition.empty())
     {
-        m_outputCtrl->SetValue(wxString::Format("Error parsing API response (invalid JSON): %s\nRaw Response: %s", e.what(), response.c_str()));
-        wxLogError("JSON parse error: %s", e.what());
+        m_outputCtrl->SetValue("Translation definition not found in response.");
+        return;
     }
-    catch (const json::exception &e)
+
+    if (result.type != "document")
+        m_suggestions.Add(NormalizeKey(word), result.persian_definition);
+    wxString rtlText = wxString::FromUTF8(result.persian_definition.c_str());
+
+    m_outputCtrl->SetValue(rtlText);
+    wxLogVerbose("Displayed translation result.");
+}
+
+void MyFrame::OnTranslationPartial(unsigned serial, const std::string &persian_definition)
+{
+    if (serial != m_requestSerial)
+        return;
+    m_outputCtrl->SetValue(wxString::FromUTF8(persian_definition.c_str()));
+}
+
+void MyFrame::OnStreamToggle(wxCommandEvent &event)
+{
+    m_streaming = event.IsChecked();
+    m_config["streaming"] = m_streaming;
+    SaveConfig();
+}
+
+void MyFrame::OnPrefetchToggle(wxCommandEvent &event)
+{
+    m_prefetch = event.IsChecked();
+    m_config["prefetch_on_hotkey"] = m_prefetch;
+    SaveConfig();
+}
+
+void MyFrame::OnClipboardWatchToggle(wxCommandEvent &event)
+{
+    if (event.IsChecked())
+        m_clipboardWatcher.Start();
+    else
+        m_clipboardWatcher.Stop();
+    m_config["clipboard_watch"] = event.IsChecked();
+    SaveConfig();
+}
+
+void MyFrame::OnInputChanged(wxCommandEvent &event)
+{
+    AbandonStaleLookup();
+    UpdateSuggestions();
+    event.Skip();
+}
+
+// Cancels a lookup (typically a prefetch) for text that is no longer in the
+// input, so its result is not shown next to different text.
+void MyFrame::AbandonStaleLookup()
+{
+    if (m_pendingRequest && GetInputWord() != m_pendingWord)
     {
-        m_outputCtrl->SetValue(wxString::Format("Error reading data from API response: %s\nRaw Response: %s", e.what(), response.c_str()));
-        wxLogError("JSON data access error: %s", e.what());
+        m_pendingRequest->Cancel();
+        m_pendingRequest.reset();
+        m_pendingWord.clear();
+        ++m_requestSerial;
+        m_outputCtrl->Clear();
     }
-    catch (const std::exception &e)
+}
+
+void MyFrame::UpdateSuggestions()
+{
+    const size_t kMaxSuggestions = 5;
+    const std::string key = NormalizeKey(GetInputWord());
+    m_shownSuggestions = key.size() < 2 ? std::vector<SuggestionIndex::Suggestion>() : m_suggestions.Suggest(key, kMaxSuggestions);
+    // An exact hit is the translation itself, not a suggestion.
+    if (m_shownSuggestions.size() == 1 && m_shownSuggestions.front().word == key)
+        m_shownSuggestions.clear();
+
+    m_suggestionList->Clear();
+    for (const SuggestionIndex::Suggestion &suggestion : m_shownSuggestions)
+        m_suggestionList->Append(wxString::FromUTF8((suggestion.word + "  \xE2\x80\x94  " + suggestion.persian).c_str()));
+    if (m_suggestionList->IsShown() != !m_shownSuggestions.empty())
     {
-        m_outputCtrl->SetValue(wxString::Format("An unexpected error occurred processing the translation: %s", e.what()));
-        wxLogError("Unexpected error during processing: %s", e.what());
+        m_suggestionList->Show(!m_shownSuggestions.empty());
+        m_panel->Layout();
     }
 }
 
+void MyFrame::OnSuggestionSelected(wxCommandEvent &event)
+{
+    const int selection = event.GetSelection();
+    if (selection < 0 || static_cast<size_t>(selection) >= m_shownSuggestions.size())
+        return;
+    const SuggestionIndex::Suggestion suggestion = m_shownSuggestions[selection];
+
+    if (m_pendingRequest)
+        m_pendingRequest->Cancel();
+    m_pendingRequest.reset();
+    m_pendingWord.clear();
+    ++m_requestSerial;
+    m_inputCtrl->ChangeValue(wxString::FromUTF8(suggestion.word.c_str()));
+    m_inputCtrl->SetInsertionPointEnd();
+    m_outputCtrl->SetValue(wxString::FromUTF8(suggestion.persian.c_str()));
+    m_shownSuggestions.clear();
+    m_suggestionList->Clear();
+    m_suggestionList->Hide();
+    m_panel->Layout();
+}
+
 void MyFrame::OnApi(wxCommandEvent &event)
 {
     (void)event; // Avoid unreferenced parameter warning
@@ -518,9 +894,18 @@ void MyFrame::OnApi(wxCommandEvent &event)
         wxString apiKey = dlg.GetValue();
         std::string apiKeyStd = apiKey.ToStdString();
 
-        m_Translator.setApiKey(apiKeyStd);
+        // The dialog edits the first key; any others stay in rotation.
+        std::vector<std::string> apiKeys = m_Translator.getApiKeys();
+        if (apiKeys.empty())
+            apiKeys.push_back(apiKeyStd);
+        else
+            apiKeys.front() = apiKeyStd;
+        m_Translator.setApiKeys(apiKeys);
 
-        m_config["api_key"] = apiKeyStd;
+        if (m_config.contains("api_keys") && m_config["api_keys"].is_array() && !m_config["api_keys"].empty())
+            m_config["api_keys"][0] = apiKeyStd;
+        else
+            m_config["api_key"] = apiKeyStd;
         SaveConfig();
 
         wxMessageBox("API Key set!", "Info", wxOK | wxICON_INFORMATION, this);
@@ -663,4 +1048,24 @@ void MyFrame::OnProxy(wxCommandEvent &event)
 
         wxMessageBox("Proxy settings saved.", "Proxy", wxOK | wxICON_INFORMATION, this);
     }
-}
\ No newline at end of file
+}
+
+void MyFrame::OnDiagnostics(wxCommandEvent &event)
+{
+    (void)event; // Avoid unreferenced parameter warning
+
+    wxDialog dlg(this, wxID_ANY, "Diagnostics", wxDefaultPosition, wxSize(560, 480), wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER);
+    wxBoxSizer *vbox = new wxBoxSizer(wxVERTICAL);
+
+    wxTextCtrl *metricsCtrl = new wxTextCtrl(&dlg, wxID_ANY, wxString::FromUTF8(m_Translator.GetMetrics().ToPrometheus()),
+                                             wxDefaultPosition, wxDefaultSize, wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP);
+    metricsCtrl->SetFont(wxFont(wxFontInfo().Family(wxFONTFAMILY_TELETYPE)));
+    vbox->Add(metricsCtrl, 1, wxEXPAND | wxALL, 5);
+
+    wxStdDialogButtonSizer *btnSizer = dlg.CreateStdDialogButtonSizer(wxOK);
+    vbox->Add(btnSizer, 0, wxALL | wxALIGN_CENTER, 10);
+
+    dlg.SetSizer(vbox);
+    dlg.Centre(wxCENTER_ON_SCREEN);
+    dlg.ShowModal();
+}
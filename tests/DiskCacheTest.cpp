@@ -0,0 +1,165 @@
+#include <DiskCache.hpp>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    class DiskCacheTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            path = (std::filesystem::temp_directory_path() /
+                    ("translatur-diskcache-" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name())))
+                       .string();
+            std::remove(path.c_str());
+        }
+
+        void TearDown() override
+        {
+            std::remove(path.c_str());
+            std::remove((path + ".tmp").c_str());
+        }
+
+        uint64_t FileSize() const
+        {
+            return static_cast<uint64_t>(std::filesystem::file_size(path));
+        }
+
+        std::string path;
+    };
+
+    std::string Value(int i)
+    {
+        return "{\"persian_definition\": \"value " + std::to_string(i) + "\"}";
+    }
+}
+
+TEST_F(DiskCacheTest, ReopensWithStoredEntries)
+{
+    {
+        DiskCache cache(path, 1 << 20);
+        cache.Store("one", Value(1));
+        cache.Store("two", Value(2));
+        cache.Store("one", Value(11)); // A later record replaces the earlier one.
+    }
+    DiskCache cache(path, 1 << 20);
+    std::string value;
+    ASSERT_TRUE(cache.Lookup("one", value));
+    EXPECT_EQ(value, Value(11));
+    ASSERT_TRUE(cache.Lookup("two", value));
+    EXPECT_EQ(value, Value(2));
+    EXPECT_FALSE(cache.Lookup("three", value));
+    EXPECT_EQ(cache.GetStats().entries, 2u);
+}
+
+TEST_F(DiskCacheTest, RecoversRecordsBeforeATruncatedTail)
+{
+    {
+        DiskCache cache(path, 1 << 20);
+        for (int i = 0; i < 5; ++i)
+            cache.Store("key" + std::to_string(i), Value(i));
+    }
+    const uint64_t intact = FileSize();
+    {
+        // A record whose header promises more bytes than the file holds, as
+        // left by a crash halfway through a write.
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        const char header[12] = {3, 0, 0, 0, 100, 0, 0, 0, 0, 0, 0, 0};
+        out.write(header, sizeof(header));
+        out.write("key", 3);
+    }
+
+    {
+        DiskCache cache(path, 1 << 20);
+        EXPECT_EQ(cache.GetStats().entries, 5u);
+        for (int i = 0; i < 5; ++i)
+        {
+            std::string value;
+            ASSERT_TRUE(cache.Lookup("key" + std::to_string(i), value));
+            EXPECT_EQ(value, Value(i));
+        }
+        // The partial record was dropped by rewriting the file, so new
+        // records are not appended behind it.
+        EXPECT_EQ(FileSize(), intact);
+        cache.Store("key5", Value(5));
+    }
+    DiskCache cache(path, 1 << 20);
+    EXPECT_EQ(cache.GetStats().entries, 6u);
+    std::string value;
+    ASSERT_TRUE(cache.Lookup("key5", value));
+    EXPECT_EQ(value, Value(5));
+}
+
+TEST_F(DiskCacheTest, RejectsValueWithBadChecksum)
+{
+    {
+        DiskCache cache(path, 1 << 20);
+        cache.Store("good", Value(1));
+        cache.Store("bad", Value(2));
+    }
+    {
+        // Flip the last byte of the file, which belongs to the value of "bad".
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-1, std::ios::end);
+        char c = 0;
+        file.get(c);
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(c ^ 0x20));
+    }
+    DiskCache cache(path, 1 << 20);
+    std::string value;
+    EXPECT_TRUE(cache.Lookup("good", value));
+    EXPECT_FALSE(cache.Lookup("bad", value));
+}
+
+TEST_F(DiskCacheTest, StartsOverOnForeignFile)
+{
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a cache file";
+    }
+    DiskCache cache(path, 1 << 20);
+    EXPECT_EQ(cache.GetStats().entries, 0u);
+    cache.Store("word", Value(1));
+    std::string value;
+    EXPECT_TRUE(cache.Lookup("word", value));
+}
+
+TEST_F(DiskCacheTest, CompactionKeepsRecentEntriesWithinLimit)
+{
+    const uint64_t max_bytes = 4096;
+    DiskCache cache(path, max_bytes);
+    const int count = 200;
+    for (int i = 0; i < count; ++i)
+    {
+        cache.Store("key" + std::to_string(i), Value(i));
+        ASSERT_LE(cache.GetStats().file_bytes, max_bytes);
+        // Keep an old entry in use so compaction has to keep it.
+        std::string value;
+        ASSERT_TRUE(cache.Lookup("key0", value));
+    }
+
+    const uint64_t entries = cache.GetStats().entries;
+    EXPECT_GT(entries, 10u);
+    EXPECT_LT(entries, static_cast<uint64_t>(count));
+    EXPECT_EQ(cache.GetStats().file_bytes, FileSize());
+    std::string value;
+    EXPECT_TRUE(cache.Lookup("key0", value));
+    EXPECT_EQ(value, Value(0));
+    EXPECT_TRUE(cache.Lookup("key" + std::to_string(count - 1), value));
+    EXPECT_FALSE(cache.Lookup("key1", value));
+
+    // Most recent first, and every visited entry is readable.
+    std::vector<std::string> keys;
+    cache.ForEach([&keys](const std::string &key, const std::string &)
+                  { keys.push_back(key); });
+    EXPECT_EQ(keys.size(), entries);
+    ASSERT_FALSE(keys.empty());
+    EXPECT_EQ(keys.front(), "key" + std::to_string(count - 1));
+}
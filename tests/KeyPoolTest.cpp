@@ -0,0 +1,48 @@
+#include <KeyPool.hpp>
+#include <RateLimiter.hpp>
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(KeyPoolTest, LeastLoadedKeyFirst)
+{
+    KeyPool pool;
+    pool.setKeys({"a", "b"});
+    KeyPool::Lease first = pool.Acquire();
+    KeyPool::Lease second = pool.Acquire();
+    EXPECT_NE(first.Key(), second.Key());
+    pool.Cooldown("a", std::chrono::minutes(1));
+    EXPECT_EQ(pool.Acquire().Key(), "b");
+}
+
+TEST(KeyPoolTest, PrefersAKeyWithRateBudget)
+{
+    RateLimiter limiter;
+    RateLimiter::Limits limits;
+    limits.requests_per_minute = 6; // A bucket of one request.
+    limiter.setLimits(limits);
+    auto reserve = [&limiter](const std::string &key)
+    { return limiter.TryAcquire(key, 0, RequestClass::Bulk); };
+
+    KeyPool pool;
+    pool.setKeys({"a", "b"});
+    {
+        KeyPool::Lease spent = pool.Acquire(reserve);
+        ASSERT_EQ(spent.Key(), "a");
+    }
+    // "a" is now the less loaded key, but its bucket is empty.
+    KeyPool::Lease busy = pool.Acquire();
+    ASSERT_EQ(busy.Key(), "b");
+    bool reserved = false;
+    KeyPool::Lease lease = pool.Acquire([&](const std::string &key)
+                                        { return reserved = reserve(key); });
+    EXPECT_EQ(lease.Key(), "b");
+    EXPECT_TRUE(reserved);
+
+    // With no budget anywhere, the least loaded key is leased to wait on.
+    reserved = false;
+    KeyPool::Lease waiting = pool.Acquire([&](const std::string &key)
+                                          { return reserved = reserve(key); });
+    EXPECT_EQ(waiting.Key(), "a");
+    EXPECT_FALSE(reserved);
+}
@@ -0,0 +1,109 @@
+#include <LruCache.hpp>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+    TranslationResult ResultFor(const std::string &key)
+    {
+        TranslationResult result;
+        result.word = key;
+        result.persian_definition = "fa-" + key;
+        return result;
+    }
+
+    // Every entry the cache counts must still be reachable through its
+    // probe sequence and hold its own value; a broken backward shift leaves
+    // entries counted but unreachable, or finds the wrong node.
+    template <typename Keys>
+    void ExpectConsistent(LruCache &cache, const Keys &keys)
+    {
+        const uint64_t entries = cache.GetStats().entries;
+        uint64_t found = 0;
+        for (const std::string &key : keys)
+        {
+            TranslationResult value;
+            if (cache.Lookup(key, value))
+            {
+                EXPECT_EQ(value.word, key);
+                EXPECT_EQ(value.persian_definition, "fa-" + key);
+                ++found;
+            }
+        }
+        EXPECT_EQ(found, entries);
+    }
+}
+
+TEST(LruCacheTest, StoresAndFinds)
+{
+    LruCache cache(1 << 20);
+    cache.Store("apple", ResultFor("apple"));
+    TranslationResult value;
+    ASSERT_TRUE(cache.Lookup("apple", value));
+    EXPECT_EQ(value.persian_definition, "fa-apple");
+    EXPECT_FALSE(cache.Lookup("pear", value));
+}
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed)
+{
+    LruCache cache(1 << 20);
+    cache.Store("a", ResultFor("a"));
+    const uint64_t one_entry = cache.GetStats().bytes;
+    cache.setMaxBytes(one_entry * 3);
+    cache.Store("b", ResultFor("b"));
+    cache.Store("c", ResultFor("c"));
+    TranslationResult value;
+    ASSERT_TRUE(cache.Lookup("a", value)); // Now "b" is the oldest.
+    cache.Store("d", ResultFor("d"));
+    EXPECT_FALSE(cache.Lookup("b", value));
+    EXPECT_TRUE(cache.Lookup("a", value));
+    EXPECT_TRUE(cache.Lookup("c", value));
+    EXPECT_TRUE(cache.Lookup("d", value));
+}
+
+// Small budget and many keys, so evictions keep deleting from the middle of
+// probe clusters while the table stays at its initial size.
+TEST(LruCacheTest, BackwardShiftDeletionKeepsProbeChains)
+{
+    LruCache cache(1 << 20);
+    cache.Store("probe", ResultFor("probe"));
+    const uint64_t one_entry = cache.GetStats().bytes;
+    cache.setMaxBytes(one_entry * 20);
+
+    std::mt19937 rng(12345);
+    std::set<std::string> keys{"probe"};
+    for (int i = 0; i < 2000; ++i)
+    {
+        const std::string key = "k" + std::to_string(rng() % 500);
+        keys.insert(key);
+        cache.Store(key, ResultFor(key));
+        TranslationResult value;
+        ASSERT_TRUE(cache.Lookup(key, value));
+        if (i % 50 == 0)
+            ExpectConsistent(cache, keys);
+    }
+    ExpectConsistent(cache, keys);
+}
+
+TEST(LruCacheTest, ShrinkingEvictsEverythingOverBudget)
+{
+    LruCache cache(1 << 20);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 200; ++i)
+    {
+        keys.push_back("word" + std::to_string(i));
+        cache.Store(keys.back(), ResultFor(keys.back()));
+    }
+    cache.setMaxBytes(0);
+    EXPECT_EQ(cache.GetStats().entries, 0u);
+    EXPECT_EQ(cache.GetStats().bytes, 0u);
+    cache.setMaxBytes(1 << 20);
+    for (const std::string &key : keys)
+        cache.Store(key, ResultFor(key));
+    ExpectConsistent(cache, keys);
+    EXPECT_EQ(cache.GetStats().entries, keys.size());
+}
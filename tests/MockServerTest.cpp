@@ -0,0 +1,64 @@
+#include <MockServer.hpp>
+#include <Rest.hpp>
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+TEST(MockServerTest, StreamedChunksKeepCharactersWhole)
+{
+    MockServer mock;
+    ASSERT_TRUE(mock.Start());
+    Translator translator;
+    translator.setApiKey("test-key");
+    translator.setBackend(std::make_shared<MockBackend>(mock.Port()));
+
+    // Persian letters are two bytes each; over a few lengths the fixed
+    // chunk size lands inside a letter at least once.
+    std::vector<std::string> expected;
+    for (int letters = 20; letters < 24; ++letters)
+    {
+        std::string persian;
+        for (int i = 0; i < letters; ++i)
+            persian += "\xd8\xb3";
+        expected.push_back(persian);
+        mock.AddResponse("{\"persian_definition\": \"" + persian + "\"}");
+    }
+
+    const std::string kReplacementCharacter = "\xef\xbf\xbd";
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool finished = false;
+        std::vector<std::string> partials;
+        std::string result;
+        std::string error;
+        auto request = translator.TranslateStreamAsync(
+            "word" + std::to_string(i),
+            [&](const std::string &persian_definition)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                partials.push_back(persian_definition);
+            },
+            [&](const TranslationResult &done, const std::string &done_error)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                result = done.persian_definition;
+                error = done_error;
+                finished = true;
+                cv.notify_all();
+            });
+
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]
+                                { return finished; }));
+        EXPECT_EQ(error, "");
+        EXPECT_EQ(result, expected[i]);
+        EXPECT_FALSE(partials.empty());
+        for (const std::string &partial : partials)
+            EXPECT_EQ(partial.find(kReplacementCharacter), std::string::npos) << "lookup " << i;
+    }
+}
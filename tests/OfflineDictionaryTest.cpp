@@ -0,0 +1,91 @@
+#include <OfflineDictionary.hpp>
+#include <TextNormalize.hpp>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    class OfflineDictionaryTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            path = (std::filesystem::temp_directory_path() /
+                    ("translatur-dictionary-" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name())))
+                       .string();
+            std::remove(path.c_str());
+        }
+
+        void TearDown() override
+        {
+            std::remove(path.c_str());
+            std::remove((path + ".tmp").c_str());
+        }
+
+        std::string path;
+    };
+}
+
+TEST_F(OfflineDictionaryTest, RoundTripsEveryEntry)
+{
+    std::vector<std::pair<std::string, std::string>> words;
+    for (int i = 0; i < 5000; ++i)
+        words.emplace_back("word" + std::to_string(i), "\xd9\x88\xd8\xa7\xda\x98\xd9\x87 " + std::to_string(i));
+    words.emplace_back(NormalizeKey("Ice Cream"), "\xd8\xa8\xd8\xb3\xd8\xaa\xd9\x86\xdb\x8c");
+    ASSERT_TRUE(OfflineDictionary::Build(words, path));
+
+    OfflineDictionary dictionary;
+    ASSERT_TRUE(dictionary.Open(path));
+    EXPECT_EQ(dictionary.Size(), words.size());
+    for (const auto &word : words)
+    {
+        std::string persian;
+        ASSERT_TRUE(dictionary.Lookup(word.first, persian)) << word.first;
+        EXPECT_EQ(persian, word.second);
+    }
+    std::string persian;
+    EXPECT_FALSE(dictionary.Lookup("word5000", persian));
+    EXPECT_FALSE(dictionary.Lookup("", persian));
+    EXPECT_TRUE(dictionary.Lookup("ice cream", persian));
+}
+
+TEST_F(OfflineDictionaryTest, LaterDuplicatesWin)
+{
+    ASSERT_TRUE(OfflineDictionary::Build({{"cat", "first"}, {"dog", "dog"}, {"cat", "second"}}, path));
+    OfflineDictionary dictionary;
+    ASSERT_TRUE(dictionary.Open(path));
+    EXPECT_EQ(dictionary.Size(), 2u);
+    std::string persian;
+    ASSERT_TRUE(dictionary.Lookup("cat", persian));
+    EXPECT_EQ(persian, "second");
+}
+
+TEST_F(OfflineDictionaryTest, EmptyDictionaryFindsNothing)
+{
+    ASSERT_TRUE(OfflineDictionary::Build({}, path));
+    OfflineDictionary dictionary;
+    ASSERT_TRUE(dictionary.Open(path));
+    EXPECT_EQ(dictionary.Size(), 0u);
+    std::string persian;
+    EXPECT_FALSE(dictionary.Lookup("anything", persian));
+}
+
+TEST_F(OfflineDictionaryTest, RejectsMissingOrForeignFiles)
+{
+    OfflineDictionary dictionary;
+    EXPECT_FALSE(dictionary.Open(path));
+    EXPECT_FALSE(dictionary.IsOpen());
+    {
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        std::fputs("not a dictionary, just some text", file);
+        std::fclose(file);
+    }
+    EXPECT_FALSE(dictionary.Open(path));
+    EXPECT_FALSE(dictionary.IsOpen());
+}
@@ -0,0 +1,122 @@
+#include <MockServer.hpp>
+#include <Rest.hpp>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // A Translator pointed at a mock server that answers slowly enough for
+    // concurrent lookups to overlap.
+    class SingleFlightTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_TRUE(mock.Start());
+            translator.setApiKey("test-key");
+            translator.setBackend(std::make_shared<MockBackend>(mock.Port()));
+        }
+
+        MockServer mock{std::chrono::milliseconds(300)};
+        Translator translator;
+    };
+}
+
+TEST_F(SingleFlightTest, ConcurrentLookupsShareOneRequest)
+{
+    std::vector<std::thread> threads;
+    std::vector<std::string> results(8);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        // Differently spelled, same cache key.
+        const std::string word = i % 2 ? "Serendipity" : "  serendipity ";
+        threads.emplace_back([this, &results, i, word]
+                             { results[i] = translator.Translate(word).persian_definition; });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(mock.RequestCount(), 1u);
+    for (const std::string &result : results)
+    {
+        EXPECT_FALSE(result.empty());
+        EXPECT_EQ(result, results.front());
+    }
+}
+
+TEST_F(SingleFlightTest, DifferentWordsAreNotCoalesced)
+{
+    std::thread other([this]
+                      { translator.Translate("first"); });
+    translator.Translate("second");
+    other.join();
+    EXPECT_EQ(mock.RequestCount(), 2u);
+}
+
+TEST_F(SingleFlightTest, CancelledFollowerLeavesLeaderRunning)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    int finished = 0;
+    std::string leader_error = "not called";
+    bool follower_called = false;
+
+    auto leader = translator.TranslateAsync("word", [&](const TranslationResult &, const std::string &error)
+                                            {
+        std::lock_guard<std::mutex> lock(mutex);
+        leader_error = error;
+        ++finished;
+        cv.notify_all(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto follower = translator.TranslateAsync("word", [&](const TranslationResult &, const std::string &)
+                                              {
+        std::lock_guard<std::mutex> lock(mutex);
+        follower_called = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    follower->Cancel();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]
+                            { return finished == 1; }));
+    EXPECT_EQ(leader_error, "");
+    EXPECT_FALSE(follower_called);
+    EXPECT_EQ(mock.RequestCount(), 1u);
+}
+
+TEST_F(SingleFlightTest, StreamingLookupsJoinTheSameFlight)
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    int finished = 0;
+    std::vector<std::string> results;
+    auto done = [&](const TranslationResult &result, const std::string &error)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(error, "");
+        results.push_back(result.persian_definition);
+        ++finished;
+        cv.notify_all();
+    };
+
+    std::vector<std::shared_ptr<TranslationRequest>> requests;
+    requests.push_back(translator.TranslateStreamAsync("streamed", PartialCallback(), done));
+    requests.push_back(translator.TranslateStreamAsync("streamed", PartialCallback(), done));
+    requests.push_back(translator.TranslateAsync("streamed", done));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]
+                            { return finished == 3; }));
+    EXPECT_EQ(mock.RequestCount(), 1u);
+    for (const std::string &result : results)
+    {
+        EXPECT_FALSE(result.empty());
+        EXPECT_EQ(result, results.front());
+    }
+}
@@ -0,0 +1,141 @@
+#include <SuggestionIndex.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Textbook dynamic-programming Levenshtein distance, the reference for
+    // the bit-parallel version.
+    int ReferenceDistance(const std::string &a, const std::string &b)
+    {
+        std::vector<int> row(b.size() + 1);
+        for (size_t j = 0; j <= b.size(); ++j)
+            row[j] = static_cast<int>(j);
+        for (size_t i = 1; i <= a.size(); ++i)
+        {
+            int diagonal = row[0];
+            row[0] = static_cast<int>(i);
+            for (size_t j = 1; j <= b.size(); ++j)
+            {
+                const int above = row[j];
+                row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+                diagonal = above;
+            }
+        }
+        return row[b.size()];
+    }
+
+    std::string RandomWord(std::mt19937 &rng, size_t min_length, size_t max_length)
+    {
+        // A small alphabet, so many words are within two edits of each other.
+        static const char kAlphabet[] = "abcde-";
+        std::uniform_int_distribution<size_t> length(min_length, max_length);
+        std::uniform_int_distribution<size_t> letter(0, sizeof(kAlphabet) - 2);
+        std::string word(length(rng), 'a');
+        for (char &c : word)
+            c = kAlphabet[letter(rng)];
+        return word;
+    }
+
+    int MaxDistance(size_t length)
+    {
+        if (length < 3)
+            return 0;
+        return length < 5 ? 1 : 2;
+    }
+}
+
+TEST(SuggestionIndexTest, PrefixMatchesComeFirstShortestFirst)
+{
+    SuggestionIndex index;
+    index.Add("serendipity", "a");
+    index.Add("seren", "b");
+    index.Add("serene", "c");
+    index.Add("sereme", "d");
+    const std::vector<SuggestionIndex::Suggestion> results = index.Suggest("seren", 10);
+    ASSERT_GE(results.size(), 3u);
+    EXPECT_EQ(results[0].word, "seren");
+    EXPECT_EQ(results[1].word, "serene");
+    EXPECT_EQ(results[2].word, "serendipity");
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_EQ(results[i].distance, 0);
+}
+
+TEST(SuggestionIndexTest, FuzzyMatchesAgreeWithReferenceDistance)
+{
+    std::mt19937 rng(2024);
+    SuggestionIndex index;
+    std::map<std::string, std::string> words;
+    for (int i = 0; i < 3000; ++i)
+    {
+        const std::string word = RandomWord(rng, 1, 12);
+        words[word] = "fa-" + word;
+        index.Add(word, "fa-" + word);
+    }
+    // Longer than the 64-character pattern limit is never fuzzy-matched,
+    // but must not break the scan.
+    index.Add(std::string(80, 'a'), "long");
+
+    for (int q = 0; q < 300; ++q)
+    {
+        const std::string query = RandomWord(rng, 3, 10);
+        const int max = MaxDistance(query.size());
+
+        std::vector<std::pair<std::string, int>> expected;
+        for (const auto &word : words)
+        {
+            if (word.first.compare(0, query.size(), query) == 0)
+                continue;
+            const int distance = ReferenceDistance(query, word.first);
+            if (distance > 0 && distance <= max)
+                expected.emplace_back(word.first, distance);
+        }
+
+        std::vector<std::pair<std::string, int>> actual;
+        for (const SuggestionIndex::Suggestion &s : index.Suggest(query, 100000))
+        {
+            if (s.distance == 0)
+            {
+                EXPECT_EQ(s.word.compare(0, query.size(), query), 0) << query << " -> " << s.word;
+                continue;
+            }
+            EXPECT_EQ(s.persian, "fa-" + s.word);
+            actual.emplace_back(s.word, s.distance);
+        }
+        // Closest first.
+        EXPECT_TRUE(std::is_sorted(actual.begin(), actual.end(), [](const auto &a, const auto &b)
+                                   { return a.second < b.second; }));
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, expected) << "query " << query;
+    }
+}
+
+TEST(SuggestionIndexTest, AddAllKeepsExistingAndFirstDuplicate)
+{
+    SuggestionIndex index;
+    index.Add("house", "session");
+    index.AddAll({{"hose", "newest"}, {"house", "history"}, {"hose", "older"}, {"apple", "a"}, {"", "x"}, {"empty", ""}});
+    EXPECT_EQ(index.Size(), 3u);
+
+    const std::vector<SuggestionIndex::Suggestion> results = index.Suggest("ho", 10);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].word, "hose");
+    EXPECT_EQ(results[0].persian, "newest");
+    EXPECT_EQ(results[1].word, "house");
+    EXPECT_EQ(results[1].persian, "session");
+
+    // Bulk-loaded words are found by prefix like added ones.
+    index.AddAll({{"apricot", "b"}, {"aardvark", "c"}});
+    const std::vector<SuggestionIndex::Suggestion> a = index.Suggest("a", 10);
+    ASSERT_EQ(a.size(), 3u);
+    EXPECT_EQ(a[0].word, "apple");
+    EXPECT_EQ(a[1].word, "apricot");
+    EXPECT_EQ(a[2].word, "aardvark");
+}
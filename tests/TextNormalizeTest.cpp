@@ -0,0 +1,81 @@
+#include <TextNormalize.hpp>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+namespace
+{
+    // U+200B ZERO WIDTH SPACE is dropped by both functions, but any byte
+    // outside printable ASCII sends the text down the decoding path. So
+    // prepending it yields the slow path's answer for the same text.
+    const std::string kZeroWidthSpace = "\xe2\x80\x8b";
+
+    std::string RandomAscii(std::mt19937 &rng, size_t max_length)
+    {
+        // Spaces are overrepresented to exercise collapsing and trimming.
+        static const char kChars[] = "   aZq.-'!~09AMz ";
+        std::uniform_int_distribution<size_t> length(0, max_length);
+        std::uniform_int_distribution<size_t> pick(0, sizeof(kChars) - 2);
+        std::string text(length(rng), ' ');
+        for (char &c : text)
+            c = kChars[pick(rng)];
+        return text;
+    }
+}
+
+TEST(TextNormalizeTest, AsciiFastPathMatchesSlowPath)
+{
+    std::mt19937 rng(7);
+    for (int i = 0; i < 5000; ++i)
+    {
+        const std::string text = RandomAscii(rng, 40);
+        EXPECT_EQ(NormalizeKey(text), NormalizeKey(kZeroWidthSpace + text)) << '"' << text << '"';
+        EXPECT_EQ(SanitizeInput(text), SanitizeInput(kZeroWidthSpace + text)) << '"' << text << '"';
+        const size_t limit = rng() % 20;
+        EXPECT_EQ(SanitizeInput(text, limit), SanitizeInput(kZeroWidthSpace + text, limit))
+            << '"' << text << "\" limit " << limit;
+    }
+}
+
+TEST(TextNormalizeTest, KeysAreLowercasedAndCollapsed)
+{
+    EXPECT_EQ(NormalizeKey("  Hello   World  "), "hello world");
+    EXPECT_EQ(NormalizeKey("Hello\r\n\tWorld"), "hello world");
+    EXPECT_EQ(NormalizeKey(""), "");
+    EXPECT_EQ(NormalizeKey("   "), "");
+}
+
+TEST(TextNormalizeTest, InputKeepsCaseAndAtMostTwoLineBreaks)
+{
+    EXPECT_EQ(SanitizeInput("  Hello   World  "), "Hello World");
+    EXPECT_EQ(SanitizeInput("One\r\n\r\n\r\n\r\nTwo"), "One\n\nTwo");
+    EXPECT_EQ(SanitizeInput("One\nTwo"), "One\nTwo");
+}
+
+TEST(TextNormalizeTest, ComposesAndDropsInvisibleCharacters)
+{
+    // "e" followed by U+0301 COMBINING ACUTE ACCENT becomes U+00E9.
+    EXPECT_EQ(NormalizeKey("Caf" "e\xcc\x81"), "caf\xc3\xa9");
+    // U+00C9 is lowercased to U+00E9.
+    EXPECT_EQ(NormalizeKey("\xc3\x89t\xc3\xa9"), "\xc3\xa9t\xc3\xa9");
+    // Alef followed by U+0653 ARABIC MADDAH ABOVE becomes U+0622.
+    EXPECT_EQ(NormalizeKey("\xd8\xa7\xd9\x93"), "\xd8\xa2");
+    // Soft hyphen, byte order mark and a malformed byte are dropped.
+    EXPECT_EQ(NormalizeKey("in\xc2\xad" "form\xef\xbb\xbf" "at\xff" "ion"), "information");
+}
+
+TEST(TextNormalizeTest, TruncatesAtCharacterBoundary)
+{
+    // Two-byte Persian letters; a three-byte limit keeps only the first.
+    EXPECT_EQ(SanitizeInput("\xd8\xb3\xd9\x84\xd8\xa7\xd9\x85", 3), "\xd8\xb3");
+    EXPECT_EQ(SanitizeInput("abcdef", 3), "abc");
+}
+
+TEST(TextNormalizeTest, CountsCodePointsNotBytes)
+{
+    EXPECT_EQ(CountCharacters(""), 0u);
+    EXPECT_EQ(CountCharacters("abc"), 3u);
+    // Two Persian letters and a four-byte emoji.
+    EXPECT_EQ(CountCharacters("\xd8\xb3\xd9\x84 \xf0\x9f\x98\x80"), 4u);
+}
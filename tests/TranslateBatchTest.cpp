@@ -0,0 +1,72 @@
+#include <MockServer.hpp>
+#include <Rest.hpp>
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::string Item(const std::string &word)
+    {
+        return "{\"word\": \"" + word + "\", \"persian_definition\": \"fa-" + word + "\"}";
+    }
+
+    class TranslateBatchTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_TRUE(mock.Start());
+            translator.setApiKey("test-key");
+            translator.setBackend(std::make_shared<MockBackend>(mock.Port()));
+        }
+
+        void ExpectTranslated(const std::vector<std::optional<TranslationResult>> &results)
+        {
+            ASSERT_EQ(results.size(), words.size());
+            for (size_t i = 0; i < words.size(); ++i)
+            {
+                ASSERT_TRUE(results[i].has_value()) << words[i];
+                EXPECT_EQ(results[i]->word, words[i]);
+                EXPECT_EQ(results[i]->persian_definition, "fa-" + words[i]);
+            }
+        }
+
+        const std::vector<std::string> words = {"one", "two", "three"};
+        MockServer mock;
+        Translator translator;
+    };
+}
+
+TEST_F(TranslateBatchTest, SplitsOneReplyBackPerInput)
+{
+    mock.AddResponse("[" + Item("one") + ", " + Item("two") + ", " + Item("three") + "]");
+    ExpectTranslated(translator.TranslateBatch(words));
+    EXPECT_EQ(mock.RequestCount(), 1u);
+
+    // Each result was cached under its own input.
+    EXPECT_EQ(translator.Translate("two", RequestClass::Bulk).persian_definition, "fa-two");
+    ExpectTranslated(translator.TranslateBatch(words));
+    EXPECT_EQ(mock.RequestCount(), 1u);
+}
+
+TEST_F(TranslateBatchTest, FallsBackToSingleLookupsWhenResultsDoNotLineUp)
+{
+    // Two results for three inputs, then one reply per single lookup.
+    mock.AddResponse("[" + Item("one") + ", " + Item("two") + "]");
+    for (const std::string &word : words)
+        mock.AddResponse(Item(word));
+    ExpectTranslated(translator.TranslateBatch(words));
+    EXPECT_EQ(mock.RequestCount(), 4u);
+}
+
+TEST_F(TranslateBatchTest, FallsBackToSingleLookupsWhenTheBatchFails)
+{
+    mock.AddResponse("not JSON");
+    for (const std::string &word : words)
+        mock.AddResponse(Item(word));
+    ExpectTranslated(translator.TranslateBatch(words));
+    EXPECT_EQ(mock.RequestCount(), 4u);
+}